@@ -0,0 +1,788 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    picasa_bench.cpp                                              //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+// Headless timings of the hot paths on a generated corpus: decoding,
+// thumbnail decode and resize, block compression, header probing,
+// directory crawling and thumbnail cache reads and writes. With --gl it
+// also times texture uploads, preferring Mesa's software rasterizer so
+// numbers from different machines stay comparable. Results are JSON with
+// latency percentiles per benchmark, for diffing between releases.
+
+#include "block_compressor.h"
+#include "directory_crawler.h"
+#include "image_decoder.h"
+#include "image_probe.h"
+#include "input_file.h"
+#include "pixel_pool.h"
+#include "resampler.h"
+#include "shader_manager.h"
+#include "texture.h"
+#include "thumbnail_cache.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string output;
+    std::string corpus;
+    std::string filter;
+    bool keepCorpus = false;
+    bool quick = false;
+    bool gl = false;
+    bool hardwareGl = false;
+    int maxIterations = 50;
+};
+
+struct Result {
+    std::string name;
+    size_t iterations = 0;
+    double meanMs = 0.0;
+    double minMs = 0.0;
+    double p50Ms = 0.0;
+    double p90Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    double itemsPerSecond = 0.0;
+    double megapixelsPerSecond = 0.0;
+    double megabytesPerSecond = 0.0;
+};
+
+struct CorpusImage {
+    std::string path;
+    std::string format;
+    int width;
+    int height;
+    size_t fileBytes;
+};
+
+struct Corpus {
+    std::vector<CorpusImage> images;
+    std::string tree;
+    size_t treeFiles = 0;
+    size_t treeDirectories = 0;
+};
+
+// Per-iteration work, for the throughput figures
+struct Work {
+    double items = 1.0;
+    double pixels = 0.0;
+    double bytes = 0.0;
+};
+
+class Bench {
+public:
+    explicit Bench(const Options& options) : m_options(options) {}
+
+    bool wants(const std::string& name) const
+    {
+        return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+    }
+
+    // Fewer runs for big inputs so every benchmark takes about as long
+    int iterationsFor(double pixels) const
+    {
+        double budget = m_options.quick ? 2e7 : 2e8;
+        int iterations = (pixels > 0.0) ? static_cast<int>(budget / pixels) : m_options.maxIterations;
+        return std::max(3, std::min(iterations, m_options.maxIterations));
+    }
+
+    // One untimed warm-up run, then `iterations` timed ones; `body` returns false on failure
+    void run(const std::string& name, int iterations, const Work& work, const std::function<bool()>& body)
+    {
+        if (!wants(name)) {
+            return;
+        }
+        if (!body()) {
+            std::cerr << "Skipping " << name << ": warm-up run failed" << std::endl;
+            return;
+        }
+
+        std::vector<double> samples;
+        samples.reserve(iterations);
+        for (int i = 0; i < iterations; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            bool ok = body();
+            auto end = std::chrono::steady_clock::now();
+            if (!ok) {
+                std::cerr << "Skipping " << name << ": run " << i << " failed" << std::endl;
+                return;
+            }
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        m_results.push_back(summarize(name, samples, work));
+        const Result& result = m_results.back();
+        std::cerr << name << ": p50 " << result.p50Ms << " ms, p99 " << result.p99Ms << " ms" << std::endl;
+    }
+
+    const std::vector<Result>& getResults() const { return m_results; }
+
+private:
+    const Options& m_options;
+    std::vector<Result> m_results;
+
+    static double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        // Nearest rank
+        size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+
+    static Result summarize(const std::string& name, std::vector<double> samples, const Work& work)
+    {
+        std::sort(samples.begin(), samples.end());
+
+        Result result;
+        result.name = name;
+        result.iterations = samples.size();
+        double total = 0.0;
+        for (double sample : samples) {
+            total += sample;
+        }
+        result.meanMs = total / samples.size();
+        result.minMs = samples.front();
+        result.p50Ms = percentile(samples, 0.50);
+        result.p90Ms = percentile(samples, 0.90);
+        result.p99Ms = percentile(samples, 0.99);
+        result.maxMs = samples.back();
+
+        // Throughput from the median, so one page fault does not move it
+        double seconds = result.p50Ms / 1000.0;
+        if (seconds > 0.0) {
+            result.itemsPerSecond = work.items / seconds;
+            result.megapixelsPerSecond = work.pixels / 1e6 / seconds;
+            result.megabytesPerSecond = work.bytes / (1024.0 * 1024.0) / seconds;
+        }
+        return result;
+    }
+};
+
+// Smooth gradients, hard edges and sensor-like noise, so the encoders see
+// something closer to a photograph than a flat fill
+std::vector<unsigned char> makePixels(int width, int height, int channels, unsigned seed)
+{
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * channels);
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> noise(-12, 12);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int band = ((x * 7 / width) + (y * 5 / height)) % 3;
+            for (int c = 0; c < channels; c++) {
+                int value = (x * 255 / width * (c + 1) + y * 255 / height * (3 - c)) / 4 + band * 40 + noise(random);
+                pixels[(static_cast<size_t>(y) * width + x) * channels + c] =
+                    static_cast<unsigned char>(std::max(0, std::min(255, value)));
+            }
+        }
+    }
+    return pixels;
+}
+
+bool writeImage(const std::string& path, const std::string& format, int width, int height,
+                const std::vector<unsigned char>& pixels, int channels)
+{
+    if (format == "jpeg") {
+        return stbi_write_jpg(path.c_str(), width, height, channels, pixels.data(), 90) != 0;
+    }
+    if (format == "png") {
+        return stbi_write_png(path.c_str(), width, height, channels, pixels.data(), width * channels) != 0;
+    }
+    return stbi_write_bmp(path.c_str(), width, height, channels, pixels.data()) != 0;
+}
+
+// A directory tree of small valid JPEGs for the crawler; every file is a
+// hard link to one image, so building it costs no disk space
+bool makeTree(const std::string& root, int directories, int filesPerDirectory, const std::string& sample, Corpus& corpus)
+{
+    corpus.tree = root;
+    for (int d = 0; d < directories; d++)
+    {
+        // Two levels, so the walk has subtrees to steal
+        std::string directory = root + "/d" + std::to_string(d % 16) + "/s" + std::to_string(d);
+        std::error_code error;
+        fs::create_directories(directory, error);
+        if (error) {
+            std::cerr << "Failed to create " << directory << ": " << error.message() << std::endl;
+            return false;
+        }
+        corpus.treeDirectories++;
+
+        for (int f = 0; f < filesPerDirectory; f++)
+        {
+            std::string path = directory + "/img" + std::to_string(f) + ((f % 10 == 9) ? ".txt" : ".jpg");
+            if (::link(sample.c_str(), path.c_str()) != 0) {
+                fs::copy_file(sample, path, fs::copy_options::overwrite_existing, error);
+                if (error) {
+                    std::cerr << "Failed to create " << path << ": " << error.message() << std::endl;
+                    return false;
+                }
+            }
+            corpus.treeFiles++;
+        }
+    }
+    return true;
+}
+
+bool makeCorpus(const Options& options, Corpus& corpus)
+{
+    struct Size {
+        int width;
+        int height;
+    };
+    std::vector<Size> sizes = {{256, 256}, {1024, 768}, {3000, 2000}};
+    if (!options.quick) {
+        sizes.push_back({6000, 4000});
+    }
+
+    std::cerr << "Generating corpus in " << options.corpus << std::endl;
+    for (const Size& size : sizes)
+    {
+        std::vector<unsigned char> rgb = makePixels(size.width, size.height, 3, size.width + size.height);
+        for (const char* format : {"jpeg", "png", "bmp"})
+        {
+            std::string name = std::string(format) + "_" + std::to_string(size.width) + "x" + std::to_string(size.height);
+            std::string path = options.corpus + "/" + name + (std::strcmp(format, "jpeg") == 0 ? ".jpg" : std::string(".") + format);
+            if (!writeImage(path, format, size.width, size.height, rgb, 3)) {
+                std::cerr << "Failed to write " << path << std::endl;
+                return false;
+            }
+            corpus.images.push_back({path, format, size.width, size.height, static_cast<size_t>(fs::file_size(path))});
+        }
+    }
+
+    std::string sample = options.corpus + "/sample.jpg";
+    if (!writeImage(sample, "jpeg", 64, 48, makePixels(64, 48, 3, 7), 3)) {
+        return false;
+    }
+    int directories = options.quick ? 64 : 512;
+    return makeTree(options.corpus + "/tree", directories, 100, sample, corpus);
+}
+
+std::string sizeName(int width, int height)
+{
+    return std::to_string(width) + "x" + std::to_string(height);
+}
+
+void benchDecoding(Bench& bench, const Corpus& corpus)
+{
+    const int kThumbnailSize = 256;
+
+    for (const CorpusImage& image : corpus.images)
+    {
+        std::string suffix = image.format + "/" + sizeName(image.width, image.height);
+        double pixels = static_cast<double>(image.width) * image.height;
+        Work work{1.0, pixels, static_cast<double>(image.fileBytes)};
+
+        // What Texture::loadFromFile does before the upload
+        bench.run("decode/" + suffix, bench.iterationsFor(pixels), work, [&image]() {
+            DecodedImage decoded;
+            return ImageDecoder::decodeFile(image.path, decoded);
+        });
+
+        bench.run("decode_thumbnail/" + suffix, bench.iterationsFor(pixels), work, [&image]() {
+            DecodedImage thumbnail;
+            return ImageDecoder::decodeThumbnail(image.path, kThumbnailSize, thumbnail);
+        });
+    }
+}
+
+void benchResizing(Bench& bench, const Corpus& corpus)
+{
+    const int kThumbnailSize = 256;
+    const std::pair<Resampler::Filter, const char*> filters[] = {
+        {Resampler::Filter::Box, "box"},
+        {Resampler::Filter::Triangle, "triangle"},
+        {Resampler::Filter::Lanczos3, "lanczos3"},
+    };
+
+    for (const CorpusImage& image : corpus.images)
+    {
+        if (image.format != "png" || !bench.wants("resize/")) {
+            continue;
+        }
+
+        DecodedImage source;
+        if (!ImageDecoder::decodeFile(image.path, source)) {
+            continue;
+        }
+
+        int width, height;
+        ImageDecoder::thumbnailDimensions(source.width, source.height, kThumbnailSize, width, height);
+        double pixels = static_cast<double>(source.width) * source.height;
+
+        for (const auto& filter : filters)
+        {
+            std::string name = std::string("resize/") + filter.second + "/" + sizeName(source.width, source.height) +
+                               "->" + sizeName(width, height);
+            bench.run(name, bench.iterationsFor(pixels), Work{1.0, pixels, 0.0}, [&, filter]() {
+                DecodedImage target;
+                return ImageDecoder::resize(source, width, height, target, filter.first);
+            });
+        }
+    }
+}
+
+void benchCompression(Bench& bench)
+{
+    const int kWidth = 256;
+    const int kHeight = 192;
+
+    for (int channels : {3, 4})
+    {
+        std::vector<unsigned char> pixels = makePixels(kWidth, kHeight, channels, 11);
+        for (BlockFormat format : {BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC7})
+        {
+            if ((format == BlockFormat::BC1) != (channels == 3)) {
+                continue;
+            }
+            std::string name = std::string("compress/") + BlockCompressor::getFormatName(format) + "/" + sizeName(kWidth, kHeight);
+            bench.run(name, bench.iterationsFor(kWidth * kHeight * 40.0), Work{1.0, kWidth * kHeight * 1.0, 0.0}, [&]() {
+                CompressedImage compressed;
+                return BlockCompressor::compress(pixels.data(), kWidth, kHeight, channels, format, compressed);
+            });
+        }
+    }
+}
+
+void benchProbing(Bench& bench, const Corpus& corpus)
+{
+    for (const char* format : {"jpeg", "png", "bmp"})
+    {
+        std::vector<std::string> paths;
+        for (const CorpusImage& image : corpus.images) {
+            if (image.format == format) {
+                paths.push_back(image.path);
+            }
+        }
+
+        bench.run(std::string("probe/") + format, bench.iterationsFor(0.0), Work{static_cast<double>(paths.size()), 0.0, 0.0}, [&paths]() {
+            ImageInfo info;
+            for (const std::string& path : paths) {
+                if (!ImageProbe::probe(path, info)) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+}
+
+void benchScanning(Bench& bench, const Corpus& corpus)
+{
+    // Same extension filter the gallery uses
+    auto filter = [](const std::string& name) {
+        size_t dot = name.find_last_of('.');
+        return dot != std::string::npos && name.compare(dot, std::string::npos, ".jpg") == 0;
+    };
+    size_t expected = corpus.treeFiles - corpus.treeFiles / 10;
+    int iterations = bench.iterationsFor(0.0) / 5 + 3;
+
+    for (bool probe : {false, true})
+    {
+        std::string name = probe ? "scan/crawl_probe" : "scan/crawl";
+        bench.run(name, iterations, Work{static_cast<double>(corpus.treeFiles), 0.0, 0.0}, [&]() {
+            DirectoryCrawler crawler;
+            CrawlOptions options;
+            options.maxDepth = -1;
+            options.probe = probe;
+            crawler.start(corpus.tree, options, filter);
+
+            std::vector<CrawledFile> files;
+            std::vector<std::string> directories;
+            while (!crawler.isDone()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            crawler.poll(files, directories);
+            return files.size() == expected;
+        });
+    }
+}
+
+void benchCache(Bench& bench, const Options& options, const Corpus& corpus)
+{
+    if (!bench.wants("cache/")) {
+        return;
+    }
+
+    // Entries are keyed by real files; the crawler tree has plenty
+    std::vector<std::string> paths;
+    for (const auto& entry : fs::recursive_directory_iterator(corpus.tree)) {
+        if (entry.is_regular_file() && paths.size() < 2000) {
+            paths.push_back(entry.path().string());
+        }
+    }
+
+    const int kThumbnailSize = 256;
+    const int kWidth = 256;
+    const int kHeight = 192;
+    std::vector<unsigned char> pixels = makePixels(kWidth, kHeight, 3, 5);
+    CompressedImage blocks;
+    BlockCompressor::compress(pixels.data(), kWidth, kHeight, 3, BlockFormat::BC1, blocks);
+
+    std::string directory = options.corpus + "/cache";
+    int iterations = bench.iterationsFor(0.0) / 5 + 3;
+    double count = static_cast<double>(paths.size());
+
+    for (bool compressed : {false, true})
+    {
+        std::string suffix = compressed ? "bc1" : "rgb";
+        double bytes = count * (compressed ? blocks.blocks.size() : pixels.size());
+        ThumbnailCache cache;
+
+        // Each run starts from an empty pack
+        bench.run("cache/store/" + suffix, iterations, Work{count, 0.0, bytes}, [&]() {
+            cache.close();
+            fs::remove_all(directory);
+            if (!cache.open(directory)) {
+                return false;
+            }
+            for (const std::string& path : paths)
+            {
+                bool stored = compressed
+                    ? cache.store(path, kThumbnailSize, blocks.blocks.data(), kWidth, kHeight, 3, BlockFormat::BC1)
+                    : cache.store(path, kThumbnailSize, pixels.data(), kWidth, kHeight, 3);
+                if (!stored) {
+                    return false;
+                }
+            }
+            return true;
+        });
+
+        // Reopened, so the index is rebuilt from the pack like at startup
+        bench.run("cache/open/" + suffix, iterations, Work{count, 0.0, bytes}, [&]() {
+            cache.close();
+            return cache.open(directory);
+        });
+
+        bench.run("cache/lookup/" + suffix, iterations, Work{count, 0.0, bytes}, [&]() {
+            ThumbnailCache::Entry entry;
+            unsigned checksum = 0;
+            for (const std::string& path : paths) {
+                if (!cache.lookup(path, kThumbnailSize, entry)) {
+                    return false;
+                }
+                checksum += entry.pixels[entry.byteSize / 2];
+            }
+            return checksum != 1;
+        });
+        cache.close();
+    }
+}
+
+// Hidden window when there is a display, otherwise GLFW's null platform
+// with an OSMesa context. Mesa is asked for llvmpipe unless --gl-hardware.
+GLFWwindow* createGlContext(const Options& options, std::string& renderer)
+{
+    if (!options.hardwareGl) {
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+        setenv("GALLIUM_DRIVER", "llvmpipe", 0);
+    }
+
+    bool display = std::getenv("DISPLAY") || std::getenv("WAYLAND_DISPLAY");
+#ifdef GLFW_PLATFORM_NULL
+    if (!display) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+#endif
+    if (!glfwInit()) {
+        return nullptr;
+    }
+
+    GLFWwindow* window = nullptr;
+    for (int attempt = 0; attempt < 2 && !window; attempt++)
+    {
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef GLFW_OSMESA_CONTEXT_API
+        if (attempt == 1 || !display) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        }
+#else
+        if (attempt == 1) {
+            break;
+        }
+#endif
+        window = glfwCreateWindow(64, 64, "picasa_bench", nullptr, nullptr);
+    }
+    if (!window) {
+        glfwTerminate();
+        return nullptr;
+    }
+
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    GLenum status = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // Headless contexts have no GLX display, the GL entry points load regardless
+    if (status == GLEW_ERROR_NO_GLX_DISPLAY) {
+        status = GLEW_OK;
+    }
+#endif
+    if (status != GLEW_OK) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return nullptr;
+    }
+
+    const GLubyte* name = glGetString(GL_RENDERER);
+    renderer = name ? reinterpret_cast<const char*>(name) : "unknown";
+    return window;
+}
+
+void benchUploads(Bench& bench, const Corpus& corpus)
+{
+    for (const CorpusImage& image : corpus.images)
+    {
+        if (image.format != "png") {
+            continue;
+        }
+
+        DecodedImage decoded;
+        if (!ImageDecoder::decodeFile(image.path, decoded)) {
+            continue;
+        }
+
+        double pixels = static_cast<double>(decoded.width) * decoded.height;
+        // glFinish keeps drivers that upload lazily honest
+        bench.run("gl/upload/" + sizeName(decoded.width, decoded.height), bench.iterationsFor(pixels),
+                  Work{1.0, pixels, static_cast<double>(decoded.pixels.size())}, [&decoded]() {
+                      Texture texture;
+                      bool loaded = texture.loadFromMemory(decoded.pixels.data(), decoded.width, decoded.height, decoded.channels);
+                      glFinish();
+                      return loaded;
+                  });
+    }
+
+    if (!Texture::isCompressionSupported(TextureCompression::S3tc)) {
+        return;
+    }
+
+    const int kWidth = 256;
+    const int kHeight = 192;
+    std::vector<unsigned char> pixels = makePixels(kWidth, kHeight, 3, 3);
+    CompressedImage blocks;
+    BlockCompressor::compress(pixels.data(), kWidth, kHeight, 3, BlockFormat::BC1, blocks);
+    bench.run("gl/upload_compressed/bc1/" + sizeName(kWidth, kHeight), bench.iterationsFor(kWidth * kHeight),
+              Work{1.0, kWidth * kHeight * 1.0, static_cast<double>(blocks.blocks.size())}, [&blocks]() {
+                  Texture texture;
+                  bool loaded = texture.loadCompressed(blocks, 3);
+                  glFinish();
+                  return loaded;
+              });
+}
+
+// The programs PicasaApp builds at startup, from source and from the binary cache
+void benchShaders(Bench& bench, const Options& options)
+{
+    std::string directory = options.corpus + "/shaders";
+    int iterations = bench.iterationsFor(0.0) / 5 + 3;
+
+    for (bool warm : {false, true})
+    {
+        bench.run(warm ? "gl/shaders/warm" : "gl/shaders/cold", iterations, Work{3.0, 0.0, 0.0}, [&]() {
+            if (!warm) {
+                fs::remove_all(directory);
+            }
+            ShaderManager manager("shaders");
+            manager.setCacheDirectory(directory);
+            bool built = manager.get("image") && manager.get("image", kShaderGrayscale) && manager.get("thumbnail");
+            glFinish();
+            return built && (warm ? manager.getStats().compiled == 0 : manager.getStats().loadedFromCache == 0);
+        });
+    }
+}
+
+std::string escape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += ' ';
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void writeJson(std::ostream& out, const Options& options, const Corpus& corpus, const std::string& renderer,
+               const std::vector<Result>& results)
+{
+    std::time_t now = std::time(nullptr);
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\n";
+    out << "  \"schema\": 1,\n";
+    out << "  \"timestamp\": \"" << timestamp << "\",\n";
+    out << "  \"system\": {\n";
+    out << "    \"threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"resampler_isa\": \"" << Resampler::getIsaName(Resampler::getBestIsa()) << "\",\n";
+    out << "    \"compiler\": \"" << escape(__VERSION__) << "\",\n";
+    out << "    \"gl_renderer\": ";
+    if (renderer.empty()) {
+        out << "null\n";
+    } else {
+        out << "\"" << escape(renderer) << "\"\n";
+    }
+    out << "  },\n";
+    out << "  \"corpus\": {\"quick\": " << (options.quick ? "true" : "false")
+        << ", \"images\": " << corpus.images.size()
+        << ", \"tree_files\": " << corpus.treeFiles
+        << ", \"tree_directories\": " << corpus.treeDirectories << "},\n";
+    IoStats io = IoStatistics::get();
+    out << "  \"io\": {\"files\": " << io.files << ", \"bytes_read\": " << io.bytesRead
+        << ", \"io_ms\": " << io.ioMs << ", \"decode_ms\": " << io.decodeMs << "},\n";
+    PixelPoolStats pool = PixelPool::getStats();
+    out << "  \"pixel_pool\": {\"peak_bytes\": " << pool.peakBytes << ", \"allocations\": " << pool.allocations
+        << ", \"reused\": " << pool.reused << ", \"failures\": " << pool.failures << "},\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << escape(r.name) << "\", \"iterations\": " << r.iterations
+            << ", \"mean_ms\": " << r.meanMs << ", \"min_ms\": " << r.minMs
+            << ", \"p50_ms\": " << r.p50Ms << ", \"p90_ms\": " << r.p90Ms
+            << ", \"p99_ms\": " << r.p99Ms << ", \"max_ms\": " << r.maxMs
+            << ", \"items_per_s\": " << r.itemsPerSecond
+            << ", \"mpix_per_s\": " << r.megapixelsPerSecond
+            << ", \"mb_per_s\": " << r.megabytesPerSecond << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+void printUsage()
+{
+    std::cerr << "Usage: picasa_bench [--output FILE] [--corpus DIR] [--keep-corpus] [--quick]\n"
+                 "                    [--filter TEXT] [--iterations N] [--gl] [--gl-hardware]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--corpus" && i + 1 < argc) {
+            options.corpus = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            options.maxIterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--keep-corpus") {
+            options.keepCorpus = true;
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--gl") {
+            options.gl = true;
+        } else if (arg == "--gl-hardware") {
+            options.gl = true;
+            options.hardwareGl = true;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    // A given directory is kept, a temporary one is not (unless asked)
+    bool temporary = options.corpus.empty();
+    if (temporary) {
+        char pattern[] = "/tmp/picasa_bench.XXXXXX";
+        if (!mkdtemp(pattern)) {
+            std::cerr << "Failed to create a corpus directory" << std::endl;
+            return 1;
+        }
+        options.corpus = pattern;
+    } else {
+        fs::create_directories(options.corpus);
+    }
+
+    Corpus corpus;
+    if (!makeCorpus(options, corpus)) {
+        return 1;
+    }
+
+    Bench bench(options);
+    benchDecoding(bench, corpus);
+    benchResizing(bench, corpus);
+    benchCompression(bench);
+    benchProbing(bench, corpus);
+    benchScanning(bench, corpus);
+    benchCache(bench, options, corpus);
+
+    std::string renderer;
+    if (options.gl)
+    {
+        GLFWwindow* window = createGlContext(options, renderer);
+        if (window) {
+            std::cerr << "GL renderer: " << renderer << std::endl;
+            benchUploads(bench, corpus);
+            benchShaders(bench, options);
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        } else {
+            std::cerr << "No GL context available, skipping GL benchmarks" << std::endl;
+        }
+    }
+
+    if (temporary && !options.keepCorpus) {
+        std::error_code error;
+        fs::remove_all(options.corpus, error);
+    }
+
+    if (options.output.empty()) {
+        writeJson(std::cout, options, corpus, renderer, bench.getResults());
+    } else {
+        std::ofstream file(options.output);
+        if (!file) {
+            std::cerr << "Failed to write " << options.output << std::endl;
+            return 1;
+        }
+        writeJson(file, options, corpus, renderer, bench.getResults());
+    }
+
+    return 0;
+}
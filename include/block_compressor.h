@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    block_compressor.h                                            //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Values are stored in the thumbnail cache, never renumber them
+enum class BlockFormat : uint8_t {
+    None = 0,
+    BC1 = 1,    // RGB, 8 bytes per 4x4 block
+    BC3 = 2,    // RGBA, 16 bytes per block
+    BC7 = 3,    // RGBA, 16 bytes per block, mode 6 only
+};
+
+// Which block formats the GPU can take: S3TC gives BC1/BC3, BPTC adds BC7
+enum class TextureCompression { None, S3tc, Bptc };
+
+// 4x4 blocks in row order, rows in the same order as the source pixels
+struct CompressedImage {
+    BlockFormat format = BlockFormat::None;
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> blocks;
+};
+
+// CPU encoder for thumbnails and previews. BC1/BC3 go through stb_dxt;
+// BC7 uses mode 6 (one subset, 4-bit indices, RGBA endpoints fitted along
+// the principal axis), which suits photographs and has no partition search.
+class BlockCompressor {
+public:
+    static BlockFormat formatFor(TextureCompression compression, int channels);
+    static bool compress(const unsigned char* pixels, int width, int height, int channels,
+                         BlockFormat format, CompressedImage& image);
+
+    static size_t blockBytes(BlockFormat format);
+    static size_t compressedSize(BlockFormat format, int width, int height);
+    static const char* getFormatName(BlockFormat format);
+};
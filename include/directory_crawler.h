@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    directory_crawler.h                                           //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "image_probe.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CrawlOptions {
+    int maxDepth = 0;                           // subdirectory levels below the root, -1 for no limit
+    std::vector<std::string> ignorePatterns;    // fnmatch() patterns on file and directory names
+    bool probe = true;                          // read headers, drop files that are not decodable images
+};
+
+struct CrawledFile {
+    std::string path;
+    ImageInfo info;     // left empty when probing is off
+};
+
+// Recursive directory walk on a pool of threads. Every worker lists its
+// directories with getdents64 and takes the file type from d_type, so only
+// filesystems that leave it unset (and symlinks) cost a stat. New
+// subdirectories go on the finding worker's own deque, idle workers steal
+// from the other end of someone else's. Matching files are then probed on
+// the same pool, after the listing work, and handed out in batches while
+// the walk is still running. Symlinked directories are not followed.
+class DirectoryCrawler {
+public:
+    // Decides on the entry name whether a regular file is reported
+    using Filter = std::function<bool(const std::string&)>;
+
+    struct Stats {
+        size_t directories = 0;
+        size_t files = 0;
+        size_t statCalls = 0;
+        size_t rejected = 0;        // failed the probe
+    };
+
+    DirectoryCrawler();
+    ~DirectoryCrawler();
+
+    // Cancels any walk in progress
+    void start(const std::string& root, const CrawlOptions& options, Filter filter, unsigned threadCount = 0);
+    void stop();
+    // Walks another directory of the same tree, `depth` levels below the root
+    void add(const std::string& directory, int depth);
+    // Probes one file and reports it like a crawled one
+    void addFile(const std::string& path);
+    // Called on a worker when results are ready or the walk finishes; set before start()
+    void setWakeCallback(std::function<void()> callback) { m_wake = std::move(callback); }
+
+    // Moves out the files and subdirectories found since the last call
+    void poll(std::vector<CrawledFile>& files, std::vector<std::string>& directories);
+    bool isDone() const { return m_outstanding.load() == 0; }
+    bool isIgnored(const char* name) const;
+    const CrawlOptions& getOptions() const { return m_options; }
+    Stats getStats() const;
+
+private:
+    struct Job {
+        std::string path;
+        int depth;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::deque<std::string> probes;
+        std::vector<CrawledFile> files;
+        std::vector<std::string> directories;
+        std::vector<char> buffer;
+        int unflushed = 0;
+    };
+
+    CrawlOptions m_options;
+    Filter m_filter;
+    std::function<void()> m_wake;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_stopping;
+    std::atomic<int> m_outstanding;     // queued plus being listed or probed
+    std::atomic<int> m_queued;
+    std::atomic<unsigned> m_nextWorker;
+    std::mutex m_idleMutex;
+    std::condition_variable m_idle;
+
+    mutable std::mutex m_resultMutex;
+    std::vector<CrawledFile> m_files;
+    std::vector<std::string> m_directories;
+
+    std::atomic<size_t> m_directoryCount;
+    std::atomic<size_t> m_fileCount;
+    std::atomic<size_t> m_statCount;
+    std::atomic<size_t> m_rejectedCount;
+
+    void workerLoop(size_t self);
+    bool takeJob(size_t self, Job& job, std::string& probe);
+    void push(size_t worker, Job job);
+    void pushProbe(size_t worker, std::string path);
+    void crawlDirectory(Worker& worker, size_t self, const Job& job);
+    void probeFile(Worker& worker, std::string path);
+    void flush(Worker& worker);
+};
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    exif_reader.h                                                 //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A JPEG stream stored inside another file (EXIF thumbnail, RAW preview)
+struct EmbeddedPreview {
+    uint64_t offset = 0;
+    uint32_t length = 0;
+    int width = 0;
+    int height = 0;
+};
+
+struct ImageMetadata {
+    int orientation = 1;                    // EXIF orientation, 1..8
+    std::vector<EmbeddedPreview> previews;  // smallest first
+};
+
+// Reads EXIF orientation and embedded JPEG previews from JPEG (APP1) and
+// TIFF based RAW files (CR2, NEF, DNG, ARW, ...). Only the IFD chains and
+// segment headers are read; preview pixels are left in the file.
+class ExifReader {
+public:
+    static bool isRawPath(const std::string& path);
+
+    static bool read(const std::string& path, ImageMetadata& metadata);
+    // Same, on a file the caller already has open
+    static bool read(int fd, uint64_t fileSize, ImageMetadata& metadata);
+    static bool readPreview(const std::string& path, const EmbeddedPreview& preview, std::vector<unsigned char>& data);
+
+    // Smallest preview with a long side of at least minSize, or nullptr
+    static const EmbeddedPreview* findPreview(const ImageMetadata& metadata, int minSize);
+    static const EmbeddedPreview* largestPreview(const ImageMetadata& metadata);
+
+    // Counter-clockwise degrees that display an image with this orientation upright.
+    // Mirrored orientations only get their rotation part.
+    static float orientationRotation(int orientation);
+    // Clockwise quarter turns that bake the same correction into pixels
+    static int orientationQuarterTurns(int orientation);
+};
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    folder_watcher.h                                              //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// One net change to a path. `Changed` covers both new files and rewrites;
+// the receiver knows which of the two it is from its own file list.
+struct FolderChange {
+    enum class Type { Changed, Removed, Renamed };
+
+    Type type;
+    std::string path;
+    std::string oldPath;    // Renamed only
+    bool directory = false;
+};
+
+// inotify watcher for the gallery folders. poll() drains what the kernel
+// queued since the last frame on the caller's thread, pairs rename
+// halves by cookie and coalesces repeated events on a path, so a burst of
+// thousands of events turns into one short list per frame. A file counts
+// as changed once it is closed after writing or moved in, never while it
+// is still being written. A loop that blocks between frames can
+// have a wake callback run once events are waiting.
+class FolderWatcher {
+public:
+    FolderWatcher();
+    ~FolderWatcher();
+
+    // Watches one directory level; subdirectories need their own call
+    bool watch(const std::string& directory);
+    // Also drops the watches below `directory`
+    void unwatch(const std::string& directory);
+    bool isWatched(const std::string& directory) const;
+    void clear();
+
+    bool isActive() const { return m_fd >= 0; }
+    // Readable when events are waiting, for callers that block on it
+    int getFd() const { return m_fd; }
+    // Runs `callback` on a helper thread when events arrive, then stays
+    // quiet until poll() has been called; an empty callback stops it
+    void setWakeCallback(std::function<void()> callback);
+
+    // Appends this frame's changes in the order they must be applied and
+    // reads at most `maxBytes` of events; the rest waits for the next call.
+    // Returns false once the kernel queue overflowed: events were lost and
+    // the caller has to rescan.
+    bool poll(std::vector<FolderChange>& changes, size_t maxBytes = 256 * 1024);
+
+private:
+    struct PendingMove {
+        std::string path;
+        bool directory;
+    };
+
+    int m_fd;
+    std::unordered_map<int, std::string> m_directories;     // watch descriptor -> path
+    std::unordered_map<uint32_t, PendingMove> m_moves;        // by cookie, waiting for their other half
+    std::vector<unsigned char> m_buffer;
+    
+    std::function<void()> m_wake;
+    std::thread m_notifier;
+    int m_notifyFd;                         // eventfd: re-arm or stop the notifier
+    std::atomic<bool> m_armed;
+    std::atomic<bool> m_notifierStopping;
+    
+    void notifierLoop();
+    void stopNotifier();
+
+    void renameDirectory(const std::string& oldPath, const std::string& newPath);
+    static std::string parentOf(const std::string& path);
+    static bool isWithin(const std::string& path, const std::string& directory);
+    void addChange(std::vector<FolderChange>& changes, std::unordered_map<std::string, size_t>& latest,
+                   FolderChange change);
+};
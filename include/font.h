@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    font.h                                                        //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A TrueType font baked once into a single channel glyph atlas. Covers
+// Latin-1 (U+0020 to U+00FF); anything else is drawn as '?'. The top left
+// 2x2 texels are solid white, so untextured quads can sample the same
+// atlas and share a draw call with the text.
+class Font {
+public:
+    struct Glyph {
+        float u0, v0, u1, v1;
+        float xOffset, yOffset;     // from the pen position on the baseline
+        float width, height;
+        float advance;
+    };
+
+    Font();
+
+    bool load(const std::string& path, float pixelHeight);
+    bool isLoaded() const { return !m_glyphs.empty(); }
+
+    // $PICASA_FONT, then a few common system monospace and sans fonts
+    static std::string findDefaultPath();
+
+    // Only once loaded
+    const Glyph& getGlyph(uint32_t codepoint) const;
+    float getAscent() const { return m_ascent; }
+    float getLineHeight() const { return m_lineHeight; }
+
+    const unsigned char* getAtlas() const { return m_atlas.data(); }
+    int getAtlasWidth() const { return m_atlasWidth; }
+    int getAtlasHeight() const { return m_atlasHeight; }
+    // Texture coordinate of the white texels
+    float getWhiteU() const { return 1.0f / m_atlasWidth; }
+    float getWhiteV() const { return 1.0f / m_atlasHeight; }
+
+private:
+    std::vector<unsigned char> m_atlas;
+    int m_atlasWidth;
+    int m_atlasHeight;
+    std::vector<Glyph> m_glyphs;
+    float m_ascent;
+    float m_lineHeight;
+};
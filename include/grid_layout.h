@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    grid_layout.h                                                 //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Scrollable thumbnail grid in window pixels (origin top left). Rendering,
+// picking and lazy loading all ask this one object where cells are.
+class GridLayout {
+public:
+    GridLayout();
+
+    void update(int viewportWidth, int viewportHeight, int cellSize, int itemCount);
+
+    void scrollBy(float pixels);
+    void scrollToItem(int index);
+    void setScroll(float scroll);
+    float getScroll() const { return m_scroll; }
+    float getMaxScroll() const;
+
+    int getColumns() const { return m_columns; }
+    int getRows() const { return m_rows; }
+    int getItemCount() const { return m_itemCount; }
+    float getCellWidth() const { return m_cellWidth; }
+    float getCellHeight() const { return m_cellHeight; }
+    int getViewportHeight() const { return m_viewportHeight; }
+
+    // Item range [first, last) of the visible rows plus marginRows on each side
+    void getVisibleRange(int marginRows, int& first, int& last) const;
+    void getCellRect(int index, float& x, float& y, float& width, float& height) const;
+    int pick(float x, float y) const;
+
+private:
+    int m_viewportWidth;
+    int m_viewportHeight;
+    int m_itemCount;
+    int m_columns;
+    int m_rows;
+    float m_cellWidth;
+    float m_cellHeight;
+    float m_scroll;
+
+    void clampScroll();
+};
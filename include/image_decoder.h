@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    image_decoder.h                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "pixel_pool.h"
+#include "resampler.h"
+
+#include <string>
+
+// CPU side pixels, bottom row first (same orientation the textures expect).
+// The pixels come from the PixelPool and go back to it when released.
+struct DecodedImage {
+    PixelBuffer pixels;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+};
+
+// Camera RAW files decode to their largest embedded JPEG preview.
+class ImageDecoder {
+public:
+    static bool readInfo(const std::string& path, int& width, int& height, int& channels);
+    static bool decodeFile(const std::string& path, DecodedImage& image);
+    static bool decodeThumbnail(const std::string& path, int size, DecodedImage& thumbnail);
+    static bool resize(const DecodedImage& source, int width, int height, DecodedImage& target,
+                       Resampler::Filter filter = Resampler::Filter::Triangle);
+    static void rotate(DecodedImage& image, int quarterTurnsClockwise);
+
+    static void thumbnailDimensions(int width, int height, int size, int& thumbWidth, int& thumbHeight);
+};
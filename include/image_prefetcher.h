@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    image_prefetcher.h                                            //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "image_decoder.h"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Decodes the current image and its neighbours in the background. The ring
+// reaches `imagesAhead` files in the direction the user is moving and half
+// that behind; decoded pixels stay resident under a byte budget, farthest
+// entries go first.
+class ImagePrefetcher {
+public:
+    ImagePrefetcher();
+    ~ImagePrefetcher();
+
+    void start(unsigned threadCount = 2);
+    void stop();
+    // Called on a worker whenever a job ends, decoded or not; set before start()
+    void setWakeCallback(std::function<void()> callback) { m_wake = std::move(callback); }
+
+    void setFiles(const std::vector<std::string>& paths);
+    void appendFiles(const std::vector<std::string>& paths);
+    // Incremental list change: decoded images move with their file, remap[old]
+    // is the new index or -1 for files that went away or changed on disk
+    void remapFiles(const std::vector<std::string>& paths, const std::vector<int>& remap);
+    void setRing(int imagesAhead, size_t byteBudget);
+    // Images past either limit are never prefetched (they are tiled instead)
+    void setImageLimits(size_t maxPixels, int maxDimension);
+    // Images above `minPixels` also get a downsample that fits `size`, shown
+    // while the full image streams to the GPU
+    void setPreviewSize(int size, size_t minPixels);
+    // `current` hands over pixels the caller decoded itself for currentIndex
+    void update(int currentIndex, int direction, std::shared_ptr<const DecodedImage> current = nullptr);
+
+    std::shared_ptr<const DecodedImage> get(int index);
+    std::shared_ptr<const DecodedImage> getPreview(int index);
+    // Still queued or decoding; false once it is resident, failed or dropped
+    bool isLoading(int index) const;
+    // In the ring, but the decode failed or did not fit
+    bool hasFailed(int index) const;
+    size_t getResidentBytes() const;
+
+private:
+    struct Slot {
+        std::shared_ptr<const DecodedImage> image;
+        std::shared_ptr<const DecodedImage> preview;
+        size_t bytes = 0;
+        bool pending = false;
+    };
+
+    std::vector<std::thread> m_threads;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+
+    std::vector<std::string> m_paths;
+    unsigned m_generation;
+    int m_imagesAhead;
+    size_t m_byteBudget;
+    size_t m_residentBytes;
+    size_t m_maxPixels;
+    int m_maxDimension;
+    int m_previewSize;
+    size_t m_previewPixels;
+
+    std::vector<int> m_wanted;
+    std::unordered_map<int, Slot> m_slots;
+    std::function<void()> m_wake;
+
+    void workerLoop();
+    int nextJob();
+    int rankOf(int index) const;
+    bool makeRoom(int index, size_t bytes);
+    void dropUnwanted();
+};
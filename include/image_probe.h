@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    image_probe.h                                                 //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class ImageFormat : uint8_t { Unknown, Jpeg, Png, Gif, Bmp, Raw };
+
+// What a file's header says about it. Dimensions are as stored; RAW files
+// report their largest embedded preview, which is what gets decoded.
+struct ImageInfo {
+    ImageFormat format = ImageFormat::Unknown;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    int orientation = 1;        // EXIF orientation, 1..8
+    uint64_t fileSize = 0;
+
+    bool isValid() const { return format != ImageFormat::Unknown && width > 0 && height > 0; }
+    // Width over height once the EXIF orientation is applied
+    float getUprightAspect() const;
+    // Relative decode cost, only meaningful for ordering work
+    double getDecodeCost() const;
+};
+
+// Decides the real format from magic bytes, whatever the extension says,
+// and reads the dimensions from the first few KB. JPEG markers past that
+// window are followed with small reads instead of loading the segments.
+class ImageProbe {
+public:
+    static constexpr size_t kHeaderBytes = 16 * 1024;
+
+    // False for unreadable, truncated or unsupported files
+    static bool probe(const std::string& path, ImageInfo& info);
+    static ImageFormat sniff(const unsigned char* data, size_t size);
+    static const char* getFormatName(ImageFormat format);
+};
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    input_file.h                                                  //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Decoder input read with pread, never mapped: files in watched folders are
+// rewritten in place while the workers read them, and a mapping would fault
+// (SIGBUS) on pages a writer truncated away. Here that is a short read and a
+// failed decode. Whole access reads the file in open(), so the read happens
+// (and is timed) there and decoding never waits on the disk; Sequential
+// access only opens it, for streaming files far larger than memory with
+// read() in chunks.
+class InputFile {
+public:
+    enum class Access { Whole, Sequential };
+
+    InputFile();
+    ~InputFile();
+
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    bool open(const std::string& path, Access access = Access::Whole);
+    void close();
+
+    size_t size() const { return m_size; }
+    // Whole access only
+    const unsigned char* data() const { return m_data.get(); }
+
+    // Sequential access; short of `bytes` only at the end of the file
+    size_t read(uint64_t offset, unsigned char* target, size_t bytes);
+
+private:
+    int m_fd;
+    std::unique_ptr<unsigned char[]> m_data;
+    size_t m_size;
+};
+
+// Process wide totals, so reading and decoding can be told apart
+struct IoStats {
+    uint64_t files = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesReadAhead = 0;
+    double ioMs = 0.0;
+    double decodeMs = 0.0;      // excludes the I/O done during the decode
+};
+
+class IoStatistics {
+public:
+    static IoStats get();
+    static void addFile();
+    static void addRead(uint64_t bytes, int64_t nanoseconds);
+    static void addReadAhead(uint64_t bytes);
+    // I/O time spent on the calling thread so far
+    static int64_t getThreadIoTime();
+};
+
+// Wall time of a decode minus the I/O the same thread did meanwhile. Only
+// the outermost timer on a thread counts, so decoders can nest.
+class DecodeTimer {
+public:
+    DecodeTimer();
+    ~DecodeTimer();
+
+    DecodeTimer(const DecodeTimer&) = delete;
+    DecodeTimer& operator=(const DecodeTimer&) = delete;
+
+private:
+    int64_t m_start;
+    int64_t m_ioStart;
+    bool m_outermost;
+};
@@ -0,0 +1,30 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    jpeg_decoder.h                                                //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "image_decoder.h"
+#include <atomic>
+#include <functional>
+#include <string>
+
+// JPEG decode through libjpeg: the IDCT can scale by 1/2, 1/4 or 1/8 on
+// its way out, and rows can be streamed without holding the whole image.
+class JpegDecoder {
+public:
+    // Top-down RGB rows; the row pointer is only valid during the call
+    using RowCallback = std::function<void(const unsigned char* row, int y)>;
+
+    static bool isJpegPath(const std::string& path);
+
+    // Decodes at the smallest DCT scale whose long side is still >= minSize
+    static bool decodeScaled(const std::string& path, int minSize, DecodedImage& image);
+    static bool decodeScaledMemory(const unsigned char* data, size_t size, int minSize, DecodedImage& image);
+
+    static bool decodeRows(const std::string& path, const RowCallback& onRow, const std::atomic<bool>* cancel);
+};
@@ -14,15 +14,42 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "thumbnail_atlas.h"
+#include "grid_layout.h"
+#include "folder_watcher.h"
+#include "directory_crawler.h"
+#include "shader.h"
+
+#include <atomic>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <memory>
 
-class Shader;
 class Texture;
+class ThumbnailCache;
+class ThumbnailLoader;
+class ImagePrefetcher;
+class TextureCache;
+class TiledImage;
+class UploadStream;
+class GpuTimer;
+class UniformBuffer;
+class ShaderManager;
+struct ImageMetadata;
 
 class PicasaApp {
 public:
+    // Milliseconds from loadImage() until something, and then the full
+    // resolution image, could be drawn; -1 while still outstanding
+    struct LoadTimings {
+        double firstPixelMs = -1.0;
+        double fullResolutionMs = -1.0;
+        bool fromPreview = false;
+    };
+    
+
     PicasaApp();
     virtual ~PicasaApp();
 
@@ -31,41 +58,171 @@ public:
     void loadFolder(const std::string& folderPath);
     void loadImage(const std::string& imagePath);
     
+    void setThumbnailCacheOptions(bool enabled, bool hashContents);
+    // Linked shader programs kept under <cache>/shaders
+    void setShaderCacheEnabled(bool enabled);
+    void setWorkerThreads(unsigned threadCount);
+    void setGridMarginRows(int rows);
+    void setPrefetchOptions(int imagesAhead, size_t byteBudget);
+    void setTextureBudget(size_t byteBudget);
+    void setUploadBudget(size_t bytesPerFrame);
+    // Falls back to the next weaker scheme the GPU supports
+    void setTextureCompression(TextureCompression compression);
+    void setCrawlOptions(const CrawlOptions& options);
+    // Frame and per-pass timings, in the title bar and the overlay (F3)
+    void setShowStats(bool show);
+    
+    const TextureCache* getTextureCache() const { return m_textureCache.get(); }
+    bool getCurrentImageSize(int& width, int& height) const;
+    const LoadTimings& getLoadTimings() const { return m_loadTimings; }
+    
     // TODO
 protected:
     GLFWwindow* m_window;
     int m_width;
     int m_height;
+    std::string m_title;
     
-    std::unique_ptr<Shader> m_shader;
+    // Handles are per program, so each image permutation keeps its own
+    struct ImageProgram {
+        Shader* shader = nullptr;
+        UniformMat4 model;
+    };
+    
+    std::unique_ptr<ShaderManager> m_shaderManager;
+    bool m_useShaderCache;
+    ImageProgram m_imageProgram;
+    ImageProgram m_grayscaleProgram;
+    // Projection and view, uploaded once per drawn frame for every program
+    std::unique_ptr<UniformBuffer> m_frameUniforms;
     GLuint m_vao;
     GLuint m_vbo;
     GLuint m_ebo;
     
     std::vector<std::string> m_imageFiles;
+    std::unordered_map<std::string, int> m_fileIndex;
     int m_currentIndex;
-    std::unique_ptr<Texture> m_currentTexture;
+    std::shared_ptr<Texture> m_currentTexture;
+    std::unique_ptr<TextureCache> m_textureCache;
+    size_t m_textureBudget;
     std::string m_current_image_path;
+    int m_imageWidth;
+    int m_imageHeight;
+    
+    // Progressive display: a preview stands in until the workers finish the decode
+    bool m_showingPreview;
+    int m_pendingIndex;
+    std::shared_ptr<Texture> m_pendingTexture;
+    std::unique_ptr<UploadStream> m_uploadStream;
+    size_t m_uploadBytesPerFrame;
+    size_t m_progressivePixels;
+    double m_loadStartTime;
+    LoadTimings m_loadTimings;
+    
+    // Images past either limit are viewed through a tile pyramid
+    std::unique_ptr<TiledImage> m_tiledImage;
+    int m_maxTextureSize;
+    size_t m_maxTexturePixels;
     
     float m_scale;
     glm::vec2 m_offset;
     float m_rotation;
+    float m_uprightRotation;
     glm::vec2 m_dragStart;
     bool m_isDragging;
     
+    enum class ThumbnailState { Empty, Requested, Resident, Failed };
+    
+    // `info` comes from the crawler's header probe and sizes the placeholder
+    struct ThumbnailCell {
+        ThumbnailAtlas::Slot slot;
+        ThumbnailState state = ThumbnailState::Empty;
+        ImageInfo info;
+    };
+    
     bool m_showThumbnails;
-    std::vector<std::unique_ptr<Texture>> m_thumbnails;
+    std::vector<ThumbnailCell> m_thumbnails;
     int m_thumbnailSize;
     
+    GridLayout m_gridLayout;
+    int m_gridMarginRows;
+    int m_windowFirst;
+    int m_windowLast;
+    bool m_thumbnailWindowDirty;
+    
+    // Changes to the open folder are applied in place, once per frame
+    std::unique_ptr<FolderWatcher> m_folderWatcher;
+    std::string m_folderPath;
+    std::vector<FolderChange> m_folderChanges;
+    
+    // The folder tree is listed in the background and fills the gallery as it goes
+    std::unique_ptr<DirectoryCrawler> m_crawler;
+    CrawlOptions m_crawlOptions;
+    std::vector<CrawledFile> m_crawlFiles;
+    std::vector<std::string> m_crawlDirectories;
+    double m_lastCrawlApply;
+    bool m_rescanning;
+    std::unordered_set<std::string> m_rescanSeen;
+    
+    Shader* m_thumbnailShader;
+    std::unique_ptr<ThumbnailAtlas> m_thumbnailAtlas;
+    GLuint m_thumbnailVao;
+    GLuint m_instanceVbo;
+    size_t m_instanceCapacity;
+    std::vector<ThumbnailInstance> m_thumbnailInstances;
+    std::vector<int> m_pageInstanceCounts;
+    std::vector<int> m_requestOrder;
+    
+    std::unique_ptr<ThumbnailCache> m_thumbnailCache;
+    bool m_useThumbnailCache;
+    bool m_hashThumbnails;
+    TextureCompression m_textureCompression;
+    
+    std::unique_ptr<ThumbnailLoader> m_thumbnailLoader;
+    unsigned m_workerThreads;
+    int m_maxThumbnailUploadsPerFrame;
+    
+    std::unique_ptr<ImagePrefetcher> m_prefetcher;
+    int m_prefetchAhead;
+    size_t m_prefetchBudget;
+    int m_navigationDirection;
+    
+    std::unique_ptr<GpuTimer> m_gpuTimer;
+    bool m_showStats;
+    std::string m_statsTitle;
+    
+    // Frames are only drawn when something marked them dirty; between them
+    // the loop blocks until input arrives or a worker wakes it
+    bool m_needsRedraw;
+    std::atomic<bool> m_wakePending;
+    
     void setupShaders();
+    ImageProgram setupImageProgram(unsigned features);
     void setupGeometry();
     
+    void requestRedraw() { m_needsRedraw = true; }
+    // Any thread; coalesced until the loop has woken up
+    void wake();
+    void waitForEvents();
+    double getWaitTimeout() const;
+    void beginFrame();
+    void endFrame();
+    // Truncated to fit; formats in place so it can run every frame
+    void formatStatsText(char* buffer, size_t size, bool detailed) const;
+    void update();
+    void processPendingImage();
+    void showFullResolution(std::shared_ptr<Texture> texture);
+    std::shared_ptr<Texture> loadPreview(const std::string& imagePath, const ImageMetadata& metadata);
+    void recordLoadTime(double& milliseconds);
     void render();
     void renderImage();
+    glm::mat4 getImageModelMatrix(int imageWidth, int imageHeight) const;
     void renderThumbnails();
+    void setThumbnailInstanceOffset(size_t firstInstance);
     void renderUI();
     
     static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+    static void windowRefreshCallback(GLFWwindow* window);
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
     static void cursorPosCallback(GLFWwindow* window, double xpos, double ypos);
@@ -75,5 +232,16 @@ protected:
     void nextImage();
     void previousImage();
     void generateThumbnails();
-    std::vector<std::string> getImageFilesInFolder(const std::string& folderPath);
+    void updateThumbnailWindow();
+    void processThumbnailUploads();
+    void requestThumbnail(int index);
+    void requestThumbnailsByCost(int first, int last);
+    void evictThumbnail(int index);
+    void processFolderChanges();
+    bool appendCrawlResults();
+    void rescanFolder();
+    int getFolderDepth(const std::string& directory) const;
+    void removeImageFiles(const std::vector<bool>& removed, std::vector<int>& remap);
+    void clearCurrentImage();
+    static bool isImagePath(const std::string& path);
 };
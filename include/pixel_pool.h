@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    pixel_pool.h                                                  //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+struct PixelPoolStats {
+    size_t inUseBytes = 0;      // rounded up to the size classes
+    size_t idleBytes = 0;       // freed, kept for the next image
+    size_t peakBytes = 0;       // in use + idle
+    size_t ceilingBytes = 0;
+    size_t idleLimitBytes = 0;
+    uint64_t allocations = 0;
+    uint64_t reused = 0;
+    uint64_t failures = 0;      // refused at the ceiling
+};
+
+// Process wide recycler for image sized buffers: decoder output (stb_image
+// allocates through it), resize targets and scratch. Blocks are rounded up
+// to four size classes per power of two and freed blocks wait on their
+// class's list, so browsing images of similar size stops going through
+// the heap (and mmap/munmap) for every one. In use + idle bytes never pass
+// the ceiling: idle blocks are dropped first, then allocations fail.
+// Blocks under kMinPooledSize go straight to malloc and are not counted.
+class PixelPool {
+public:
+    static const size_t kMinPooledSize = 64 * 1024;
+
+    // malloc/realloc/free semantics; realloc keeps the block when it fits
+    static void* allocate(size_t size);
+    static void* reallocate(void* block, size_t size);
+    static void release(void* block);
+    // Size last requested for a live block
+    static size_t getSize(const void* block);
+
+    static void setCeiling(size_t bytes);
+    // Idle blocks past this are freed right away
+    static void setIdleLimit(size_t bytes);
+    static void trim();
+    static PixelPoolStats getStats();
+};
+
+// Owns one pool block, like a std::vector<unsigned char> that cannot be
+// copied. New bytes are left uninitialized.
+class PixelBuffer {
+public:
+    PixelBuffer() : m_data(nullptr), m_size(0) {}
+    ~PixelBuffer() { PixelPool::release(m_data); }
+
+    PixelBuffer(PixelBuffer&& other) noexcept : m_data(other.m_data), m_size(other.m_size)
+    {
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+
+    PixelBuffer& operator=(PixelBuffer&& other) noexcept
+    {
+        swap(other);
+        other.clear();
+        return *this;
+    }
+
+    PixelBuffer(const PixelBuffer&) = delete;
+    PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+    // Keeps the first min(old, new) bytes; false (and unchanged) at the ceiling
+    bool resize(size_t size);
+    // Takes over a block from PixelPool::allocate(), e.g. stbi_load output
+    void adopt(unsigned char* block);
+    void clear();
+
+    void swap(PixelBuffer& other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+    }
+
+    unsigned char* data() { return m_data; }
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    unsigned char& operator[](size_t index) { return m_data[index]; }
+    const unsigned char& operator[](size_t index) const { return m_data[index]; }
+    unsigned char* begin() { return m_data; }
+    unsigned char* end() { return m_data + m_size; }
+    const unsigned char* begin() const { return m_data; }
+    const unsigned char* end() const { return m_data + m_size; }
+
+private:
+    unsigned char* m_data;
+    size_t m_size;
+};
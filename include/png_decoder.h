@@ -0,0 +1,28 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    png_decoder.h                                                 //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+// Row streaming PNG decode through libpng, for images that should never be
+// held in memory as a whole. Interlaced files are left to stb_image.
+class PngDecoder {
+public:
+    // Top-down rows; the row pointer is only valid during the call
+    using RowCallback = std::function<void(const unsigned char* row, int y)>;
+
+    static bool isPngPath(const std::string& path);
+    static bool readHeader(const std::string& path, int& width, int& height, bool& hasAlpha, bool& interlaced);
+
+    // Rows are converted to 8-bit RGB (channels == 3) or RGBA (channels == 4)
+    static bool decodeRows(const std::string& path, int channels, const RowCallback& onRow,
+                           const std::atomic<bool>* cancel);
+};
@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    profiler.h                                                    //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Timed spans from any thread plus GPU pass times. The frame thread's spans
+// are averaged for the stats overlay; with a trace open every span goes to
+// its thread's track and is written as Chrome trace JSON (chrome://tracing,
+// ui.perfetto.dev). While neither is on a scope costs one atomic load.
+class Profiler {
+public:
+    struct ScopeStats {
+        const char* name;
+        double cpuMs = 0.0;     // per frame
+        double gpuMs = 0.0;
+    };
+
+    // Averages over the last half second of frames. A frame is the work
+    // between beginFrame() and endFrame(), so time spent waiting for events
+    // counts toward neither the frame times nor the frame rate; fps is the
+    // rate the measured frame time would sustain.
+    struct FrameStats {
+        double frameMs = 0.0;
+        double worstFrameMs = 0.0;
+        double fps = 0.0;
+        std::vector<ScopeStats> scopes;     // in order of first appearance
+    };
+
+    static void setStatsEnabled(bool enabled);
+    static bool isStatsEnabled();
+    // Spans are kept in memory until stopTrace() writes them out
+    static bool startTrace(const std::string& path);
+    static bool stopTrace();
+    static bool isActive() { return s_active.load(std::memory_order_relaxed); }
+
+    // Names the calling thread's track
+    static void setThreadName(const std::string& name);
+
+    // Nanoseconds since the first call
+    static int64_t now();
+    static void record(const char* name, int64_t start, int64_t end, const std::string* detail = nullptr);
+    static void recordGpu(const char* pass, double milliseconds);
+
+    // Makes the caller the frame thread; only its spans feed the stats
+    static void beginFrame();
+    static void endFrame();
+    static const FrameStats& getFrameStats();
+
+private:
+    static std::atomic<bool> s_active;
+};
+
+// `name` must outlive the program (a literal); `detail` only has to outlive the scope
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name, const std::string* detail = nullptr)
+        : m_name(Profiler::isActive() ? name : nullptr), m_detail(detail), m_start(m_name ? Profiler::now() : 0)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (m_name) {
+            Profiler::record(m_name, m_start, Profiler::now(), m_detail);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    const std::string* m_detail;
+    int64_t m_start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_SCOPE_DETAIL(name, detail) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, &(detail))
+
+// GL_TIME_ELAPSED queries around whole passes. Queries cannot nest, so only
+// top level passes are timed. Results are read a few frames later, once
+// the GPU has them, and never waited for.
+class GpuTimer {
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    // False while another pass is running or too many are in flight
+    bool begin(const char* pass);
+    void end();
+    // Hands finished queries to the profiler, oldest first
+    void collect();
+
+private:
+    struct Query {
+        GLuint id;
+        const char* pass;
+    };
+
+    std::vector<GLuint> m_free;
+    std::deque<Query> m_inFlight;
+    bool m_running;
+};
+
+class GpuScope {
+public:
+    GpuScope(GpuTimer* timer, const char* pass)
+        : m_timer((timer && Profiler::isActive() && timer->begin(pass)) ? timer : nullptr)
+    {
+    }
+
+    ~GpuScope()
+    {
+        if (m_timer) {
+            m_timer->end();
+        }
+    }
+
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+    GpuTimer* m_timer;
+};
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    read_ahead_pool.h                                             //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Keeps the page cache ahead of the decoders on batch loads. A few threads
+// readahead(2) queued files in order, so many reads are in flight while
+// the workers decode, and their InputFile::open() finds the pages already
+// resident. Nothing is copied. Reading pauses once `byteBudget` bytes are
+// ahead of what the workers consumed.
+class ReadAheadPool {
+public:
+    // Returns false for files that do not need reading, e.g. cached ones
+    using Filter = std::function<bool(const std::string& path)>;
+
+    ReadAheadPool();
+    ~ReadAheadPool();
+
+    // Set the filter before start()
+    void setFilter(Filter filter) { m_filter = std::move(filter); }
+    void start(unsigned threadCount = 4, size_t byteBudget = 64u * 1024 * 1024);
+    void stop();
+
+    void enqueue(const std::string& path);
+    // A worker is about to read the file itself (or no longer wants it)
+    void consume(const std::string& path);
+    void clear();
+
+private:
+    std::vector<std::thread> m_threads;
+    std::deque<std::string> m_queue;
+    // Files read ahead or being read, and their size once known
+    std::unordered_map<std::string, size_t> m_ahead;
+    size_t m_aheadBytes;
+    size_t m_byteBudget;
+    uint64_t m_generation;
+    bool m_stopping;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    Filter m_filter;
+
+    void threadLoop();
+};
@@ -0,0 +1,30 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    resampler.h                                                   //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Separable 8-bit image resampler. Weights are precomputed per output
+// pixel in 1.14 fixed point; a horizontal pass into an intermediate buffer
+// is followed by a vertical pass. The kernel set (scalar, SSE2, AVX2) is
+// picked once from the running CPU, all of them produce identical output.
+class Resampler {
+public:
+    enum class Filter { Box, Triangle, Lanczos3 };
+    enum class Isa { Scalar, Sse2, Avx2 };
+
+    // 1-4 interleaved channels, tightly packed rows, edges clamped
+    static bool resize(const unsigned char* source, int sourceWidth, int sourceHeight, int channels,
+                       unsigned char* target, int targetWidth, int targetHeight,
+                       Filter filter = Filter::Triangle);
+
+    static Isa getIsa();
+    static Isa getBestIsa();
+    // Falls back to the best supported set; meant for checks and benchmarks
+    static void setIsa(Isa isa);
+    static const char* getIsaName(Isa isa);
+};
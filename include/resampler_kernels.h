@@ -0,0 +1,40 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    resampler_kernels.h                                           //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Inner loops of Resampler, one set per instruction set. Every output
+// pixel has exactly `taps` contributors starting at start[x], all inside
+// the row, so the loops never need bounds checks.
+const int kResampleWeightBits = 14;
+
+using ResampleHorizontalKernel = void (*)(const unsigned char* row, const unsigned char* rowEnd,
+                                          unsigned char* target, int targetWidth, int channels,
+                                          const int* start, const int16_t* weights, int taps);
+using ResampleVerticalKernel = void (*)(const unsigned char* const* rows, const int16_t* weights, int taps,
+                                        unsigned char* target, size_t bytes);
+
+void resampleHorizontalScalar(const unsigned char* row, const unsigned char* rowEnd, unsigned char* target,
+                              int targetWidth, int channels, const int* start, const int16_t* weights, int taps);
+void resampleVerticalScalar(const unsigned char* const* rows, const int16_t* weights, int taps,
+                            unsigned char* target, size_t bytes);
+
+#if defined(__x86_64__) || defined(__i386__)
+void resampleHorizontalSse2(const unsigned char* row, const unsigned char* rowEnd, unsigned char* target,
+                            int targetWidth, int channels, const int* start, const int16_t* weights, int taps);
+void resampleVerticalSse2(const unsigned char* const* rows, const int16_t* weights, int taps,
+                          unsigned char* target, size_t bytes);
+
+void resampleHorizontalAvx2(const unsigned char* row, const unsigned char* rowEnd, unsigned char* target,
+                            int targetWidth, int channels, const int* start, const int16_t* weights, int taps);
+void resampleVerticalAvx2(const unsigned char* const* rows, const int16_t* weights, int taps,
+                          unsigned char* target, size_t bytes);
+#endif
@@ -9,8 +9,26 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+// A uniform location resolved once after link. Setting through a handle
+// is a plain glUniform call; an invalid handle is silently ignored, like
+// location -1 in GL.
+template <typename T>
+struct UniformHandle {
+    GLint location = -1;
+    bool isValid() const { return location >= 0; }
+};
+
+using UniformInt = UniformHandle<int>;      // also bool and sampler uniforms
+using UniformFloat = UniformHandle<float>;
+using UniformVec2 = UniformHandle<glm::vec2>;
+using UniformVec3 = UniformHandle<glm::vec3>;
+using UniformVec4 = UniformHandle<glm::vec4>;
+using UniformMat4 = UniformHandle<glm::mat4>;
 
 class Shader {
 public:
@@ -19,8 +37,30 @@ public:
 
     bool loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath);
     bool loadFromSource(const std::string& vertexSource, const std::string& fragmentSource);
+    // A program saved with getBinary(); fails quietly if the driver rejects it
+    bool loadFromBinary(GLenum format, const void* data, GLsizei length);
+    bool getBinary(GLenum& format, std::vector<unsigned char>& data) const;
     void use();
     
+    bool isLinked() const { return m_id != 0; }
+    // ARB_get_program_binary with at least one binary format
+    static bool isBinarySupported();
+    
+    // Warns once if the program has no such uniform or its GLSL type differs
+    template <typename T>
+    UniformHandle<T> getUniform(const std::string& name);
+    
+    // Attaches a `layout(std140) uniform <block>` to a UniformBuffer binding point
+    bool bindUniformBlock(const std::string& blockName, GLuint binding);
+    
+    void set(UniformInt uniform, int value) { glUniform1i(uniform.location, value); }
+    void set(UniformFloat uniform, float value) { glUniform1f(uniform.location, value); }
+    void set(UniformVec2 uniform, const glm::vec2& value) { glUniform2f(uniform.location, value.x, value.y); }
+    void set(UniformVec3 uniform, const glm::vec3& value) { glUniform3f(uniform.location, value.x, value.y, value.z); }
+    void set(UniformVec4 uniform, const glm::vec4& value) { glUniform4f(uniform.location, value.x, value.y, value.z, value.w); }
+    void set(UniformMat4 uniform, const glm::mat4& value) { glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &value[0][0]); }
+    
+    // By name; each call hashes the name, so keep these off per-draw paths
     void setBool(const std::string& name, bool value);
     void setInt(const std::string& name, int value);
     void setFloat(const std::string& name, float value);
@@ -30,10 +70,18 @@ public:
     void setMat4(const std::string& name, const float* value);
 
 private:
+    struct UniformInfo {
+        GLint location;
+        GLenum type;
+    };
+    
     GLuint m_id;
-    std::unordered_map<std::string, GLint> m_uniformLocations;
+    // Every active uniform, filled right after link
+    std::unordered_map<std::string, UniformInfo> m_uniforms;
     
     bool compileShader(const std::string& source, GLenum type, GLuint& shader);
     bool linkProgram(GLuint vertexShader, GLuint fragmentShader);
+    void queryUniforms();
     GLint getUniformLocation(const std::string& name);
+    GLint findUniform(const std::string& name, bool (*matchesType)(GLenum));
 };
@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    shader_manager.h                                              //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "shader.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Optional features a program is built with, as #defines after #version
+enum ShaderFeature : unsigned {
+    kShaderGrayscale = 1u << 0,             // GRAYSCALE: red channel shown as grey
+    kShaderPremultipliedAlpha = 1u << 1,    // PREMULTIPLIED_ALPHA: for glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA)
+    kShaderInstancing = 1u << 2,            // INSTANCING: model matrix per instance, attributes 2-5
+    kShaderYCbCr = 1u << 3,                 // YCBCR: texture holds full range BT.601 YCbCr
+};
+
+// Builds <directory>/<name>.vert and .frag once per feature set. Linked
+// programs are saved as driver binaries keyed by a hash of the final
+// sources and the GL vendor, renderer and version, so a warm start links
+// every program without compiling anything.
+class ShaderManager {
+public:
+    struct Stats {
+        int compiled = 0;
+        int loadedFromCache = 0;
+    };
+
+    explicit ShaderManager(const std::string& sourceDirectory = "shaders");
+
+    // Empty disables the binary cache, as does a driver without binary formats
+    void setCacheDirectory(const std::string& directory);
+
+    // Owned by the manager; nullptr if the program does not build
+    Shader* get(const std::string& name, unsigned features = 0);
+    const Stats& getStats() const { return m_stats; }
+
+    static std::string getDefines(unsigned features);
+
+private:
+    std::string m_sourceDirectory;
+    std::string m_cacheDirectory;
+    std::string m_driver;
+    // Failed programs stay in as nullptr so they are not retried every frame
+    std::unordered_map<std::string, std::unique_ptr<Shader>> m_programs;
+    std::unordered_map<std::string, std::string> m_sources;
+    Stats m_stats;
+
+    bool readSource(const std::string& path, std::string& source);
+    bool loadBinary(Shader& shader, const std::string& path, uint64_t hash);
+    void storeBinary(const Shader& shader, const std::string& path, uint64_t hash);
+};
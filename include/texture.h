@@ -8,7 +8,10 @@
 
 #pragma once
 
+#include "block_compressor.h"
+
 #include <GL/glew.h>
+#include <cstddef>
 #include <string>
 #include <memory>
 
@@ -19,22 +22,33 @@ public:
 
     bool loadFromFile(const std::string& path);
     bool loadFromMemory(const unsigned char* data, int width, int height, int channels);
+    // Single level of BC blocks, sampled without mipmaps
+    bool loadCompressed(const unsigned char* blocks, size_t bytes, int width, int height, int channels, BlockFormat format);
+    bool loadCompressed(const CompressedImage& image, int channels);
+    // Storage only; the pixels arrive later, e.g. through an UploadStream
+    bool allocate(int width, int height, int channels);
     void bind(unsigned int slot = 0);
     
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
     int getChannels() const { return m_channels; }
     GLuint getId() const { return m_id; }
-    
-    std::unique_ptr<Texture> createThumbnail(int size);
+    size_t getByteSize() const;
+    GLenum getFormat() const;
+    BlockFormat getCompressedFormat() const { return m_compressedFormat; }
+    bool isCompressed() const { return m_compressedFormat != BlockFormat::None; }
+
+    static GLenum getCompressedInternalFormat(BlockFormat format);
+    static bool isCompressionSupported(TextureCompression compression);
 
 private:
     GLuint m_id;
     int m_width;
     int m_height;
     int m_channels;
+    BlockFormat m_compressedFormat;
+    size_t m_compressedBytes;
     
     void generateTexture();
     GLenum getInternalFormat() const;
-    GLenum getFormat() const;
 };
@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    texture_cache.h                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class Texture;
+
+// Recently viewed full resolution textures, keyed by image path and kept
+// under a VRAM byte budget. The least recently used entry is evicted first;
+// a texture still on screen stays alive through its shared_ptr.
+class TextureCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t residentBytes = 0;
+        size_t budgetBytes = 0;
+        size_t entries = 0;
+    };
+
+    explicit TextureCache(size_t budgetBytes);
+    ~TextureCache();
+
+    std::shared_ptr<Texture> find(const std::string& path);
+    void insert(const std::string& path, std::shared_ptr<Texture> texture);
+    void erase(const std::string& path);
+    void clear();
+
+    void setBudget(size_t budgetBytes);
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    struct Entry {
+        std::string path;
+        std::shared_ptr<Texture> texture;
+        size_t bytes;
+    };
+
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_lookup;
+    Stats m_stats;
+
+    void evictToBudget();
+};
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    thumbnail_atlas.h                                             //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "block_compressor.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+class UploadStream;
+
+// Per-instance attributes of shaders/thumbnail.vert
+struct ThumbnailInstance {
+    float rect[4];      // center xy, size xy
+    float uvRect[4];    // uv min xy, uv max xy
+    float layer;
+};
+
+// Thumbnails packed into GL_TEXTURE_2D_ARRAY pages, one thumbnail per layer.
+// Each layer is layerSize x layerSize and the thumbnail sits in its lower
+// left corner, so the grid can draw a whole page with one instanced call.
+// A page holds one format: raw RGBA8 or one of the BC block formats.
+class ThumbnailAtlas {
+public:
+    struct Slot {
+        int page = -1;
+        int layer = -1;
+        int width = 0;
+        int height = 0;
+
+        bool isValid() const { return layer >= 0; }
+    };
+
+    ThumbnailAtlas();
+    ~ThumbnailAtlas();
+
+    // The layer size is rounded up to whole 4x4 blocks
+    bool initialize(int layerSize, int layersPerPage, TextureCompression compression = TextureCompression::None);
+    // Uploads are staged through the stream while it has room this frame
+    void setUploadStream(UploadStream* stream) { m_uploadStream = stream; }
+    bool upload(const unsigned char* pixels, int width, int height, int channels, Slot& slot);
+    bool uploadCompressed(const unsigned char* blocks, size_t bytes, int width, int height, BlockFormat format, Slot& slot);
+    void release(Slot& slot);
+    void clear();
+
+    int getLayerSize() const { return m_layerSize; }
+    int getPageCount() const { return static_cast<int>(m_pages.size()); }
+    GLuint getPageTexture(int page) const { return m_pages[page].texture; }
+
+    // Texture coordinate rectangle of a slot, inset by half a texel
+    void getUvRect(const Slot& slot, float uv[4]) const;
+
+private:
+    struct Page {
+        GLuint texture = 0;
+        BlockFormat format = BlockFormat::None;
+        std::vector<int> freeLayers;
+    };
+
+    int m_layerSize;
+    int m_layersPerPage;
+    std::vector<Page> m_pages;
+    std::vector<unsigned char> m_expandBuffer;
+    UploadStream* m_uploadStream;
+
+    bool acquireLayer(BlockFormat format, Slot& slot);
+    bool addPage(BlockFormat format);
+};
@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    thumbnail_cache.h                                             //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "block_compressor.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+// Persistent thumbnail store. All thumbnails live in one append-only pack
+// file that is memory mapped on open; the index is rebuilt by scanning the
+// records, so a torn tail after a crash is simply cut off. Entries are keyed
+// by path and checked against size/mtime (and optionally a content hash) on
+// every lookup, superseded and stale records are dropped by compaction.
+// Records hold raw pixels or BC blocks ready for glCompressedTexImage, so a
+// warm load neither decodes nor encodes. One process at a time owns the
+// pack through a lock file; others open it read-only and never store,
+// truncate or compact.
+class ThumbnailCache {
+public:
+    struct Entry {
+        const unsigned char* pixels;    // or blocks, see format
+        int width;
+        int height;
+        int channels;
+        BlockFormat format;
+        size_t byteSize;
+    };
+
+    ThumbnailCache();
+    ~ThumbnailCache();
+
+    bool open(const std::string& directory);
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+    bool isReadOnly() const { return m_readOnly; }
+
+    // Entry pixels point into the mapping and stay valid until close()
+    bool lookup(const std::string& path, int thumbnailSize, Entry& entry);
+    bool store(const std::string& path, int thumbnailSize,
+               const unsigned char* pixels, int width, int height, int channels,
+               BlockFormat format = BlockFormat::None);
+
+    void setHashContents(bool enabled) { m_hashContents = enabled; }
+
+    static std::string defaultDirectory();
+
+private:
+    struct IndexEntry {
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    std::string m_packPath;
+    std::string m_lockPath;
+    int m_fd;
+    int m_lockFd;
+    bool m_readOnly;
+    unsigned char* m_map;
+    size_t m_mapSize;
+    uint64_t m_fileSize;
+    uint64_t m_liveBytes;
+    uint64_t m_deadBytes;
+    bool m_hashContents;
+
+    std::unordered_map<std::string, IndexEntry> m_index;
+    std::mutex m_mutex;
+
+    bool lockPack();
+    void unlockPack();
+    bool openPack();
+    bool mapPack();
+    void unmapPack();
+    void scanRecords();
+    bool compact();
+    bool isRecordCurrent(const unsigned char* record, const std::string& path, int thumbnailSize);
+};
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    thumbnail_loader.h                                            //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "block_compressor.h"
+#include "image_decoder.h"
+#include "thumbnail_cache.h"
+#include "lock_free_queue.h"
+#include "read_ahead_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ThumbnailResult {
+    enum class Status { Loaded, Failed, Skipped };
+
+    int index = -1;
+    unsigned generation = 0;
+    Status status = Status::Loaded;
+    bool fromCache = false;
+    ThumbnailCache::Entry cached = {};
+    DecodedImage image;
+    CompressedImage compressed;     // filled from `image` when compression is on
+
+    bool isCompressed() const { return format() != BlockFormat::None; }
+    BlockFormat format() const { return fromCache ? cached.format : compressed.format; }
+    size_t byteSize() const { return fromCache ? cached.byteSize : (isCompressed() ? compressed.blocks.size() : image.pixels.size()); }
+    const unsigned char* pixels() const
+    {
+        if (fromCache) {
+            return cached.pixels;
+        }
+        return isCompressed() ? compressed.blocks.data() : image.pixels.data();
+    }
+    int width() const { return fromCache ? cached.width : image.width; }
+    int height() const { return fromCache ? cached.height : image.height; }
+    int channels() const { return fromCache ? cached.channels : image.channels; }
+};
+
+// Decodes and resizes thumbnails on a pool of worker threads. Cells are
+// requested individually as they scroll into view; jobs that have left the
+// window by the time a worker gets to them come back as Skipped. Finished
+// pixels go to the GL thread through a lock-free queue; nothing in here
+// touches GL. Requested files that are not cached are read ahead of the
+// workers, so a batch keeps the disk busy instead of one file per worker.
+class ThumbnailLoader {
+public:
+    ThumbnailLoader();
+    ~ThumbnailLoader();
+
+    void start(unsigned threadCount = 0);
+    void stop();
+    // Called on a worker after each result is queued; set before start()
+    void setWakeCallback(std::function<void()> callback) { m_wake = std::move(callback); }
+
+    // Starts a new generation; queued jobs and older results are dropped.
+    // With compression on, thumbnails come back (and are cached) as BC blocks.
+    void setFiles(const std::vector<std::string>& paths, int thumbnailSize, ThumbnailCache* cache,
+                  TextureCompression compression = TextureCompression::None);
+    // Same generation: adds files after the existing ones
+    void appendFiles(const std::vector<std::string>& paths);
+    void setWindow(int first, int last);
+    void request(int index);
+    void cancel();
+
+    bool poll(ThumbnailResult& result);
+    bool isBusy() const;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+private:
+    struct Batch {
+        std::vector<std::string> paths;
+        int thumbnailSize = 0;
+        ThumbnailCache* cache = nullptr;
+        TextureCompression compression = TextureCompression::None;
+        unsigned generation = 0;
+    };
+
+    std::vector<std::thread> m_threads;
+    std::shared_ptr<const Batch> m_batch;
+    std::deque<int> m_jobs;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+
+    std::atomic<unsigned> m_generation;
+    std::atomic<int> m_windowFirst;
+    std::atomic<int> m_windowLast;
+    std::atomic<int> m_activeJobs;
+    LockFreeQueue<ThumbnailResult> m_results;
+    std::function<void()> m_wake;
+    ReadAheadPool m_readAhead;
+
+    void workerLoop();
+    void processJob(const Batch& batch, int index);
+};
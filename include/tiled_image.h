@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    tiled_image.h                                                 //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "shader.h"
+
+// Multi-resolution tile pyramid for images too large for one texture.
+// A background thread streams the source scanlines (JPEG and non-interlaced
+// PNG never hold more than one row) into fixed-size tiles in a memory
+// mapped scratch file and fills the coarser levels as tile rows complete.
+// Rendering picks the level matching the on-screen scale and uploads only
+// the visible tiles into a bounded LRU of GPU textures.
+class TiledImage {
+public:
+    TiledImage();
+    ~TiledImage();
+
+    bool open(const std::string& path, int width, int height, const std::string& scratchDirectory);
+    void close();
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getChannels() const { return m_channels; }
+    int getLevelCount() const { return static_cast<int>(m_levels.size()); }
+    bool isComplete() const { return m_complete.load(); }
+    // True once the coarsest level (the whole image in one tile) can be drawn
+    bool hasPreview() const;
+
+    void setResidentTileLimit(int tiles) { m_maxResidentTiles = tiles; }
+    // Called on the builder thread as tile rows become drawable; set before open()
+    void setWakeCallback(std::function<void()> callback) { m_wake = std::move(callback); }
+
+    // Expects the shader bound with projection set; `model` maps the unit quad onto the image.
+    // False when the per-frame upload limit left ready tiles out, so another frame is needed.
+    bool render(Shader& shader, UniformMat4 modelUniform, GLuint vao, const glm::mat4& model, int viewportWidth, int viewportHeight);
+
+    static constexpr int kTileSize = 512;
+    // Largest pyramid allowed on a scratch directory backed by RAM (tmpfs)
+    static constexpr size_t kMaxMemoryScratchBytes = size_t(256) * 1024 * 1024;
+
+private:
+    struct Level {
+        int width;
+        int height;
+        int tilesX;
+        int tilesY;
+        uint64_t offset;
+    };
+
+    struct GpuTile {
+        uint64_t key;
+        GLuint texture;
+    };
+
+    std::string m_path;
+    int m_width;
+    int m_height;
+    int m_channels;
+    std::vector<Level> m_levels;
+
+    int m_fd;
+    unsigned char* m_map;
+    size_t m_mapSize;
+    size_t m_tileBytes;
+
+    std::thread m_builder;
+    std::atomic<bool> m_cancel;
+    std::atomic<bool> m_complete;
+    std::unique_ptr<std::atomic<int>[]> m_rowsReady;
+    std::function<void()> m_wake;
+
+    std::list<GpuTile> m_gpuTiles;
+    std::unordered_map<uint64_t, std::list<GpuTile>::iterator> m_gpuLookup;
+    int m_maxResidentTiles;
+    int m_maxUploadsPerFrame;
+
+    enum class Source { Jpeg, Png, Decoded };
+    Source m_source;
+
+    void build();
+    bool streamDecoded();
+    void storeRow(const unsigned char* row, int y);
+    void finishLevelZeroRows(int rows);
+    void buildLevelRow(int level, int tileRow);
+
+    unsigned char* tileData(int level, int tx, int ty) const;
+    void tileValidSize(int level, int tx, int ty, int& width, int& height) const;
+    bool isTileReady(int level, int ty) const;
+
+    static uint64_t tileKey(int level, int tx, int ty);
+    GLuint findTile(uint64_t key);
+    GLuint uploadTile(int level, int tx, int ty);
+    void drawTile(Shader& shader, UniformMat4 modelUniform, const glm::mat4& model, int level, int tx, int ty, GLuint texture);
+    void releaseTiles();
+};
@@ -14,31 +14,42 @@
 #include <vector>
 #include <functional>
 
+#include "ui_renderer.h"
+
+class ShaderManager;
+
 class UIElement {
 public:
     UIElement(float x, float y, float width, float height);
     virtual ~UIElement() = default;
     
     bool isMouseOver(float mouseX, float mouseY) const;
-    virtual void render() = 0;
+    // Appends the element's geometry; only called when something changed
+    virtual void render(UIRenderer& renderer) = 0;
     virtual void onMouseClick() {}
     
     void setPosition(float x, float y);
     void setSize(float width, float height);
     void setVisible(bool visible);
     bool isVisible() const;
+    void setHovered(bool hovered);
+    
+    // True if the geometry changed since the last call
+    bool clearDirty();
     
 protected:
     float m_x, m_y;
     float m_width, m_height;
     bool m_visible;
+    bool m_hovered;
+    bool m_dirty;
 };
 
 class Button : public UIElement {
 public:
     Button(float x, float y, float width, float height, const std::string& text);
     
-    void render() override;
+    void render(UIRenderer& renderer) override;
     void onMouseClick() override;
     
     void setText(const std::string& text);
@@ -47,17 +58,23 @@ public:
 private:
     std::string m_text;
     std::function<void()> m_callback;
+    UIRenderer::TextMesh m_textMesh;
+    bool m_layoutDirty;
 };
 
 class Label : public UIElement {
 public:
     Label(float x, float y, const std::string& text);
     
-    void render() override;
+    void render(UIRenderer& renderer) override;
+    // Unchanged text costs a compare; changed text is laid out on the next render
     void setText(const std::string& text);
+    void setText(const char* text);
     
 private:
     std::string m_text;
+    UIRenderer::TextMesh m_textMesh;
+    bool m_layoutDirty;
 };
 
 class UIManager {
@@ -65,10 +82,12 @@ public:
     UIManager();
     ~UIManager();
     
-    void initialize(int windowWidth, int windowHeight);
+    bool initialize(int windowWidth, int windowHeight, ShaderManager& shaderManager);
+    // Rebuilds the vertex buffer only if an element changed, then draws it in one call
     void render();
     
-    void handleMouseMove(float mouseX, float mouseY);
+    // True when the hovered element changed
+    bool handleMouseMove(float mouseX, float mouseY);
     bool handleMouseClick(float mouseX, float mouseY);
     
     void addElement(UIElement* element);
@@ -82,8 +101,6 @@ private:
     int m_windowHeight;
     UIElement* m_hoveredElement;
     
-    GLuint m_vao;
-    GLuint m_vbo;
-    GLuint m_textVAO;
-    GLuint m_textVBO;
+    UIRenderer m_renderer;
+    bool m_dirty;
 };
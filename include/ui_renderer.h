@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    ui_renderer.h                                                 //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "shader.h"
+#include "font.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ShaderManager;
+
+// Retained geometry for every widget: triangles in window pixels (y down)
+// with a color per vertex, kept in one dynamic vertex buffer and drawn
+// with a single call. Text samples the font's glyph atlas and solid quads
+// its white texels, so both go out together. Widgets append between
+// clear() and upload(); frames in between just draw what was uploaded last.
+class UIRenderer {
+public:
+    struct Vertex {
+        float x, y;
+        float u, v;
+        uint32_t color;     // RGBA8, normalized by the vertex fetch
+    };
+
+    // Glyph quads laid out once from the top left corner, in white
+    struct TextMesh {
+        std::vector<Vertex> vertices;
+        float width = 0.0f;
+        float height = 0.0f;
+    };
+
+    UIRenderer();
+    ~UIRenderer();
+
+    UIRenderer(const UIRenderer&) = delete;
+    UIRenderer& operator=(const UIRenderer&) = delete;
+
+    bool initialize(ShaderManager& shaderManager);
+
+    void clear();
+    void addRect(float x, float y, float width, float height, const glm::vec4& color);
+    // Drawn inside the rectangle, `thickness` pixels wide
+    void addOutline(float x, float y, float width, float height, float thickness, const glm::vec4& color);
+    // Reuses the mesh's storage; UTF-8, '\n' starts a new line
+    void layoutText(const std::string& text, TextMesh& mesh) const;
+    void addText(const TextMesh& mesh, float x, float y, const glm::vec4& color);
+    float getLineHeight() const;
+    void upload();
+
+    void draw(int windowWidth, int windowHeight);
+
+private:
+    Shader* m_shader;
+    UniformVec2 m_screenSizeUniform;
+    Font m_font;
+    GLuint m_atlasTexture;
+    float m_whiteU;
+    float m_whiteV;
+    GLuint m_vao;
+    GLuint m_vbo;
+    size_t m_capacity;
+    std::vector<Vertex> m_vertices;
+    GLsizei m_uploadedCount;
+
+    void createAtlasTexture();
+    static uint32_t packColor(const glm::vec4& color);
+};
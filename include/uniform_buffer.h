@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    uniform_buffer.h                                              //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// Binding points shared by every program (see Shader::bindUniformBlock)
+enum UniformBinding : GLuint {
+    kFrameUniforms = 0,
+};
+
+// Matches `layout(std140) uniform Frame` in the shaders; mat4 columns are
+// vec4 aligned in std140, so the C++ layout needs no padding
+struct FrameUniforms {
+    glm::mat4 projection;
+    glm::mat4 view;
+};
+
+// A uniform buffer object bound to one binding point. Data written with
+// update() is seen by every program whose block is bound to that point.
+class UniformBuffer {
+public:
+    UniformBuffer();
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    bool create(GLuint binding, size_t size);
+    void update(const void* data, size_t size);
+
+    template <typename T>
+    void update(const T& data) { update(&data, sizeof(T)); }
+
+    GLuint getBinding() const { return m_binding; }
+
+private:
+    GLuint m_id;
+    GLuint m_binding;
+    size_t m_size;
+};
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    upload_stream.h                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Texture;
+struct DecodedImage;
+
+// Texture uploads through a ring of pixel unpack buffer sections, one per
+// frame in flight. Callers write pixels straight into the mapped section,
+// the copies into textures are issued from the PBO at endFrame() and fenced,
+// so neither the driver nor the render loop ever waits on a transfer. A
+// section holds one frame's byte budget; larger textures are streamed in
+// row bands over several frames.
+//
+// Uses a persistently mapped buffer (GL_ARB_buffer_storage) when available,
+// otherwise maps each section unsynchronized, the fences keep that safe.
+// Decoded images are not decoded into the mapping: their bands are copied
+// in from the DecodedImage. With a persistent map a copy thread does that
+// while the frame renders and the band's copy is issued at the next
+// beginFrame(); without one the copy runs on the GL thread at endFrame().
+class UploadStream {
+public:
+    struct Stats {
+        size_t frameBytes = 0;        // uploaded in the last frame
+        size_t totalBytes = 0;
+        size_t stalledFrames = 0;     // section still in use by the GPU
+        size_t pendingTextures = 0;
+    };
+
+    UploadStream();
+    ~UploadStream();
+
+    bool initialize(size_t bytesPerFrame, int framesInFlight = 3);
+    void shutdown();
+    bool isPersistent() const { return m_persistent; }
+
+    void beginFrame();
+    void endFrame();
+
+    // Space in this frame's section, nullptr once the budget is spent
+    unsigned char* allocate(size_t bytes, size_t& offset);
+    void copyToTexture(GLuint texture, int width, int height, GLenum format, size_t offset);
+    void copyToTextureLayer(GLuint texture, int layer, int width, int height, GLenum format, size_t offset);
+    // `format` is the compressed internal format, width and height whole blocks
+    void copyCompressedToTextureLayer(GLuint texture, int layer, int width, int height, GLenum format,
+                                      size_t bytes, size_t offset);
+
+    // `texture` must already have storage (Texture::allocate); mipmaps are
+    // generated after the last band
+    void uploadTexture(const std::shared_ptr<Texture>& texture, std::shared_ptr<const DecodedImage> image);
+    bool isPending(const Texture* texture) const;
+    void cancel(const Texture* texture);
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    struct Copy {
+        GLenum target;
+        GLuint texture;
+        int y;
+        int layer;
+        int width;
+        int height;
+        GLenum format;
+        size_t offset;
+        bool generateMipmap;
+        size_t compressedBytes = 0;
+    };
+
+    struct TextureJob {
+        std::shared_ptr<Texture> texture;
+        std::shared_ptr<const DecodedImage> image;
+        int nextRow = 0;
+    };
+
+    // Read by the copy thread while m_copyBusy, the image keeps `source` alive
+    struct BandWrite {
+        std::shared_ptr<const DecodedImage> image;
+        const unsigned char* source;
+        unsigned char* target;
+        size_t bytes;
+    };
+
+    // GL thread only; issued once the band's write has finished
+    struct BandCopy {
+        std::shared_ptr<Texture> texture;
+        Copy copy;
+    };
+
+    GLuint m_buffer;
+    bool m_persistent;
+    unsigned char* m_persistentMap;
+    size_t m_sectionSize;
+    int m_sectionCount;
+    int m_section;
+    std::vector<GLsync> m_fences;
+
+    unsigned char* m_sectionMap;
+    size_t m_used;
+    bool m_available;
+
+    std::vector<Copy> m_copies;
+    std::deque<TextureJob> m_jobs;
+    Stats m_stats;
+
+    std::vector<BandWrite> m_bandWrites;
+    std::vector<BandCopy> m_bandCopies;
+    int m_bandSection;
+    std::thread m_copyThread;
+    std::mutex m_copyMutex;
+    std::condition_variable m_copyCondition;
+    bool m_copyBusy;
+    bool m_copyStopping;
+
+    void streamTextureJobs();
+    void issueCopy(const Copy& copy);
+    void finishBands();
+    void waitForBandWrites();
+    void copyLoop();
+    size_t countPendingTextures() const;
+};
@@ -7,5 +7,19 @@ uniform sampler2D imageTexture;
 
 void main()
 {
-    FragColor = texture(imageTexture, TexCoord);
+    vec4 color = texture(imageTexture, TexCoord);
+#ifdef YCBCR
+    // Full range BT.601, as JPEG stores it
+    float y = color.r;
+    float cb = color.g - 0.5;
+    float cr = color.b - 0.5;
+    color.rgb = vec3(y + 1.402 * cr, y - 0.344136 * cb - 0.714136 * cr, y + 1.772 * cb);
+#endif
+#ifdef GRAYSCALE
+    color.rgb = color.rrr;
+#endif
+#ifdef PREMULTIPLIED_ALPHA
+    color.rgb *= color.a;
+#endif
+    FragColor = color;
 }
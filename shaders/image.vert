@@ -4,11 +4,20 @@ layout (location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
 
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+};
+
+#ifdef INSTANCING
+layout (location = 2) in mat4 model;
+#else
 uniform mat4 model;
-uniform mat4 projection;
+#endif
 
 void main()
 {
-    gl_Position = projection * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
     TexCoord = aTexCoord;
 }
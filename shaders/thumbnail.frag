@@ -0,0 +1,16 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 TexCoord;
+
+uniform sampler2DArray thumbnailTexture;
+
+void main()
+{
+    // Layer -1 is a placeholder for a thumbnail still loading
+    if (TexCoord.z < 0.0) {
+        FragColor = vec4(0.25, 0.25, 0.25, 1.0);
+        return;
+    }
+    FragColor = texture(thumbnailTexture, TexCoord);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aRect;
+layout (location = 3) in vec4 aUvRect;
+layout (location = 4) in float aLayer;
+
+out vec3 TexCoord;
+
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+};
+
+void main()
+{
+    vec2 position = aRect.xy + aPos.xy * aRect.zw;
+    gl_Position = projection * view * vec4(position, 0.0, 1.0);
+    TexCoord = vec3(mix(aUvRect.xy, aUvRect.zw, aTexCoord), aLayer);
+}
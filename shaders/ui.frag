@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 Color;
+
+// Glyph coverage; solid quads sample its white corner
+uniform sampler2D atlasTexture;
+
+void main()
+{
+    FragColor = vec4(Color.rgb, Color.a * texture(atlasTexture, TexCoord).r);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+// Window size in pixels; widgets are laid out from the top left corner
+uniform vec2 screenSize;
+
+void main()
+{
+    vec2 position = aPos / screenSize * 2.0 - 1.0;
+    gl_Position = vec4(position.x, -position.y, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Color = aColor;
+}
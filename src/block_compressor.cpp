@@ -0,0 +1,338 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    block_compressor.cpp                                          //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "block_compressor.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#define STB_DXT_IMPLEMENTATION
+#include <stb/stb_dxt.h>
+
+namespace {
+
+const int kBc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Block texels as RGBA, edges replicated past the image
+void gatherBlock(const unsigned char* pixels, int width, int height, int channels, int bx, int by, unsigned char block[64])
+{
+    for (int y = 0; y < 4; ++y) {
+        int sy = std::min(by * 4 + y, height - 1);
+        for (int x = 0; x < 4; ++x) {
+            int sx = std::min(bx * 4 + x, width - 1);
+            const unsigned char* p = pixels + (static_cast<size_t>(sy) * width + sx) * channels;
+            unsigned char* t = block + (y * 4 + x) * 4;
+            if (channels >= 3) {
+                t[0] = p[0];
+                t[1] = p[1];
+                t[2] = p[2];
+                t[3] = (channels == 4) ? p[3] : 255;
+            } else {
+                t[0] = t[1] = t[2] = p[0];
+                t[3] = (channels == 2) ? p[1] : 255;
+            }
+        }
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(unsigned char* target) : m_target(target), m_position(0)
+    {
+        std::memset(m_target, 0, 16);
+    }
+
+    void write(uint32_t value, int bits)
+    {
+        for (int i = 0; i < bits; ++i, ++m_position) {
+            if (value & (1u << i)) {
+                m_target[m_position >> 3] |= static_cast<unsigned char>(1u << (m_position & 7));
+            }
+        }
+    }
+
+private:
+    unsigned char* m_target;
+    int m_position;
+};
+
+struct Bc7Endpoints {
+    int quantized[2][4];    // 7 bits per channel
+    int pbit[2];
+};
+
+int expandEndpoint(const Bc7Endpoints& e, int endpoint, int channel)
+{
+    return (e.quantized[endpoint][channel] << 1) | e.pbit[endpoint];
+}
+
+void quantizeEndpoint(const float color[4], int pbit, Bc7Endpoints& e, int endpoint)
+{
+    e.pbit[endpoint] = pbit;
+    for (int c = 0; c < 4; ++c) {
+        float value = std::max(0.0f, std::min(255.0f, color[c]));
+        e.quantized[endpoint][c] = std::max(0, std::min(127, static_cast<int>(std::lround((value - pbit) / 2.0f))));
+    }
+}
+
+// Nearest palette entry per texel; returns the summed squared error
+int selectIndices(const unsigned char block[64], const Bc7Endpoints& e, int indices[16])
+{
+    int palette[16][4];
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            int a = expandEndpoint(e, 0, c);
+            int b = expandEndpoint(e, 1, c);
+            palette[i][c] = ((64 - kBc7Weights[i]) * a + kBc7Weights[i] * b + 32) >> 6;
+        }
+    }
+
+    int total = 0;
+    for (int t = 0; t < 16; ++t)
+    {
+        int best = 0;
+        int bestError = std::numeric_limits<int>::max();
+        for (int i = 0; i < 16; ++i)
+        {
+            int error = 0;
+            for (int c = 0; c < 4; ++c) {
+                int d = palette[i][c] - block[t * 4 + c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = i;
+            }
+        }
+        indices[t] = best;
+        total += bestError;
+    }
+    return total;
+}
+
+// The p-bits are shared by all channels of an endpoint, so every pairing
+// is tried; mixed pairs are what reproduce odd and even values side by side
+int fitEndpoints(const unsigned char block[64], const float low[4], const float high[4],
+                 Bc7Endpoints& endpoints, int indices[16])
+{
+    int bestError = std::numeric_limits<int>::max();
+    for (int p = 0; p < 4; ++p)
+    {
+        Bc7Endpoints candidate;
+        int candidateIndices[16];
+        quantizeEndpoint(low, p & 1, candidate, 0);
+        quantizeEndpoint(high, p >> 1, candidate, 1);
+        int error = selectIndices(block, candidate, candidateIndices);
+        if (error < bestError) {
+            bestError = error;
+            endpoints = candidate;
+            std::copy(candidateIndices, candidateIndices + 16, indices);
+        }
+    }
+    return bestError;
+}
+
+// Least squares endpoints for fixed indices
+bool refitEndpoints(const unsigned char block[64], const int indices[16], float low[4], float high[4])
+{
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (int t = 0; t < 16; ++t)
+    {
+        float b = kBc7Weights[indices[t]] / 64.0f;
+        float a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < 4; ++c) {
+            ax[c] += a * block[t * 4 + c];
+            bx[c] += b * block[t * 4 + c];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) {
+        return false;
+    }
+    for (int c = 0; c < 4; ++c) {
+        low[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+        high[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+    }
+    return true;
+}
+
+void encodeBc7Block(const unsigned char block[64], unsigned char* target)
+{
+    // Principal axis by power iteration on the covariance
+    float mean[4] = {};
+    for (int t = 0; t < 16; ++t) {
+        for (int c = 0; c < 4; ++c) {
+            mean[c] += block[t * 4 + c] / 16.0f;
+        }
+    }
+
+    float covariance[4][4] = {};
+    for (int t = 0; t < 16; ++t) {
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                covariance[i][j] += (block[t * 4 + i] - mean[i]) * (block[t * 4 + j] - mean[j]);
+            }
+        }
+    }
+
+    float axis[4] = { 1.0f, 1.0f, 1.0f, 0.25f };
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float next[4] = {};
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+        }
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+        if (length < 1e-6f) {
+            break;
+        }
+        for (int i = 0; i < 4; ++i) {
+            axis[i] = next[i] / length;
+        }
+    }
+
+    float minProjection = std::numeric_limits<float>::max();
+    float maxProjection = -std::numeric_limits<float>::max();
+    for (int t = 0; t < 16; ++t)
+    {
+        float projection = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            projection += (block[t * 4 + c] - mean[c]) * axis[c];
+        }
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    float low[4], high[4];
+    for (int c = 0; c < 4; ++c) {
+        low[c] = mean[c] + axis[c] * minProjection;
+        high[c] = mean[c] + axis[c] * maxProjection;
+    }
+
+    Bc7Endpoints endpoints;
+    int indices[16];
+    int error = fitEndpoints(block, low, high, endpoints, indices);
+
+    // One least squares pass usually pulls the endpoints in past the extremes
+    Bc7Endpoints refined;
+    int refinedIndices[16];
+    if (error > 0 && refitEndpoints(block, indices, low, high) &&
+        fitEndpoints(block, low, high, refined, refinedIndices) < error) {
+        endpoints = refined;
+        std::copy(refinedIndices, refinedIndices + 16, indices);
+    }
+
+    // The anchor texel's index drops its top bit, so it must be below 8
+    if (indices[0] >= 8)
+    {
+        std::swap(endpoints.quantized[0], endpoints.quantized[1]);
+        std::swap(endpoints.pbit[0], endpoints.pbit[1]);
+        for (int& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter bits(target);
+    bits.write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        bits.write(static_cast<uint32_t>(endpoints.quantized[0][c]), 7);
+        bits.write(static_cast<uint32_t>(endpoints.quantized[1][c]), 7);
+    }
+    bits.write(static_cast<uint32_t>(endpoints.pbit[0]), 1);
+    bits.write(static_cast<uint32_t>(endpoints.pbit[1]), 1);
+    bits.write(static_cast<uint32_t>(indices[0]), 3);
+    for (int t = 1; t < 16; ++t) {
+        bits.write(static_cast<uint32_t>(indices[t]), 4);
+    }
+}
+
+} // namespace
+
+BlockFormat BlockCompressor::formatFor(TextureCompression compression, int channels)
+{
+    bool alpha = (channels == 2 || channels == 4);
+    switch (compression) {
+        case TextureCompression::None: return BlockFormat::None;
+        case TextureCompression::S3tc: return alpha ? BlockFormat::BC3 : BlockFormat::BC1;
+        case TextureCompression::Bptc: return BlockFormat::BC7;
+    }
+    return BlockFormat::None;
+}
+
+bool BlockCompressor::compress(const unsigned char* pixels, int width, int height, int channels,
+                               BlockFormat format, CompressedImage& image)
+{
+    PROFILE_SCOPE("compress");
+    if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4 || format == BlockFormat::None) {
+        return false;
+    }
+
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size_t bytesPerBlock = blockBytes(format);
+
+    image.format = format;
+    image.width = width;
+    image.height = height;
+    image.blocks.resize(compressedSize(format, width, height));
+
+    unsigned char block[64];
+    unsigned char* target = image.blocks.data();
+    for (int by = 0; by < blocksY; ++by) {
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            gatherBlock(pixels, width, height, channels, bx, by, block);
+            switch (format) {
+                case BlockFormat::BC1: stb_compress_dxt_block(target, block, 0, STB_DXT_HIGHQUAL); break;
+                case BlockFormat::BC3: stb_compress_dxt_block(target, block, 1, STB_DXT_HIGHQUAL); break;
+                case BlockFormat::BC7: encodeBc7Block(block, target); break;
+                case BlockFormat::None: break;
+            }
+            target += bytesPerBlock;
+        }
+    }
+
+    return true;
+}
+
+size_t BlockCompressor::blockBytes(BlockFormat format)
+{
+    switch (format) {
+        case BlockFormat::BC1: return 8;
+        case BlockFormat::BC3:
+        case BlockFormat::BC7: return 16;
+        case BlockFormat::None: break;
+    }
+    return 0;
+}
+
+size_t BlockCompressor::compressedSize(BlockFormat format, int width, int height)
+{
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+const char* BlockCompressor::getFormatName(BlockFormat format)
+{
+    switch (format) {
+        case BlockFormat::None: return "none";
+        case BlockFormat::BC1: return "BC1";
+        case BlockFormat::BC3: return "BC3";
+        case BlockFormat::BC7: return "BC7";
+    }
+    return "unknown";
+}
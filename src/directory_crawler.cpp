@@ -0,0 +1,376 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    directory_crawler.cpp                                         //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "directory_crawler.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Layout the kernel writes for getdents64
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+// Large reads mean fewer round trips on network filesystems
+const size_t kListingBufferSize = 256 * 1024;
+// Results go out at least this often inside one huge directory
+const size_t kFlushEntries = 4096;
+const int kFlushProbes = 256;
+
+} // namespace
+
+DirectoryCrawler::DirectoryCrawler()
+    : m_stopping(false),
+      m_outstanding(0),
+      m_queued(0),
+      m_nextWorker(0),
+      m_directoryCount(0),
+      m_fileCount(0),
+      m_statCount(0),
+      m_rejectedCount(0)
+{
+}
+
+DirectoryCrawler::~DirectoryCrawler()
+{
+    stop();
+}
+
+void DirectoryCrawler::start(const std::string& root, const CrawlOptions& options, Filter filter, unsigned threadCount)
+{
+    stop();
+
+    // Listing is latency bound, so more threads than cores keeps more requests in flight
+    if (threadCount == 0) {
+        threadCount = std::min(64u, std::max(8u, 2 * std::thread::hardware_concurrency()));
+    }
+
+    m_options = options;
+    m_filter = std::move(filter);
+    m_stopping = false;
+    m_outstanding = 0;
+    m_queued = 0;
+    m_directoryCount = 0;
+    m_fileCount = 0;
+    m_statCount = 0;
+    m_rejectedCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_resultMutex);
+        m_files.clear();
+        m_directories.clear();
+    }
+
+    m_workers.clear();
+    for (unsigned i = 0; i < threadCount; i++) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+
+    add(root, 0);
+
+    for (unsigned i = 0; i < threadCount; i++) {
+        m_threads.emplace_back(&DirectoryCrawler::workerLoop, this, i);
+    }
+}
+
+void DirectoryCrawler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_stopping = true;
+    }
+    m_idle.notify_all();
+
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    m_threads.clear();
+    m_workers.clear();
+    m_outstanding = 0;
+    m_queued = 0;
+}
+
+void DirectoryCrawler::add(const std::string& directory, int depth)
+{
+    if (m_workers.empty()) {
+        return;
+    }
+    push(m_nextWorker++ % m_workers.size(), Job{directory, depth});
+}
+
+void DirectoryCrawler::addFile(const std::string& path)
+{
+    if (m_workers.empty()) {
+        return;
+    }
+    pushProbe(m_nextWorker++ % m_workers.size(), path);
+}
+
+void DirectoryCrawler::poll(std::vector<CrawledFile>& files, std::vector<std::string>& directories)
+{
+    std::lock_guard<std::mutex> lock(m_resultMutex);
+    files.insert(files.end(), std::make_move_iterator(m_files.begin()), std::make_move_iterator(m_files.end()));
+    directories.insert(directories.end(), std::make_move_iterator(m_directories.begin()),
+                       std::make_move_iterator(m_directories.end()));
+    m_files.clear();
+    m_directories.clear();
+}
+
+bool DirectoryCrawler::isIgnored(const char* name) const
+{
+    for (const std::string& pattern : m_options.ignorePatterns) {
+        if (fnmatch(pattern.c_str(), name, FNM_PERIOD) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+DirectoryCrawler::Stats DirectoryCrawler::getStats() const
+{
+    Stats stats;
+    stats.directories = m_directoryCount.load();
+    stats.files = m_fileCount.load();
+    stats.statCalls = m_statCount.load();
+    stats.rejected = m_rejectedCount.load();
+    return stats;
+}
+
+void DirectoryCrawler::push(size_t worker, Job job)
+{
+    m_outstanding++;
+    {
+        std::lock_guard<std::mutex> lock(m_workers[worker]->mutex);
+        m_workers[worker]->jobs.push_back(std::move(job));
+    }
+    std::lock_guard<std::mutex> lock(m_idleMutex);
+    m_queued++;
+    m_idle.notify_one();
+}
+
+void DirectoryCrawler::pushProbe(size_t worker, std::string path)
+{
+    m_outstanding++;
+    {
+        std::lock_guard<std::mutex> lock(m_workers[worker]->mutex);
+        m_workers[worker]->probes.push_back(std::move(path));
+    }
+    std::lock_guard<std::mutex> lock(m_idleMutex);
+    m_queued++;
+    m_idle.notify_one();
+}
+
+bool DirectoryCrawler::takeJob(size_t self, Job& job, std::string& probe)
+{
+    // Listing first, it is what feeds everyone else. Own directories newest
+    // first (depth first, warm dentries), stolen ones oldest first (closest
+    // to the root, so the biggest subtrees move). Probes go in found order.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (size_t i = 0; i < m_workers.size(); i++)
+        {
+            Worker& worker = *m_workers[(self + i) % m_workers.size()];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (pass == 0 && !worker.jobs.empty()) {
+                if (i == 0) {
+                    job = std::move(worker.jobs.back());
+                    worker.jobs.pop_back();
+                } else {
+                    job = std::move(worker.jobs.front());
+                    worker.jobs.pop_front();
+                }
+                m_queued--;
+                return true;
+            }
+            if (pass == 1 && !worker.probes.empty()) {
+                probe = std::move(worker.probes.front());
+                worker.probes.pop_front();
+                m_queued--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void DirectoryCrawler::workerLoop(size_t self)
+{
+    Worker& worker = *m_workers[self];
+    worker.buffer.resize(kListingBufferSize);
+    Profiler::setThreadName("crawler");
+
+    while (!m_stopping.load())
+    {
+        Job job;
+        std::string probe;
+        if (!takeJob(self, job, probe)) {
+            // Parked until more work is pushed; the count only changes under
+            // m_idleMutex, so no wakeup is lost between the check and the wait
+            flush(worker);
+            std::unique_lock<std::mutex> lock(m_idleMutex);
+            m_idle.wait(lock, [this] { return m_stopping.load() || m_queued.load() > 0; });
+            continue;
+        }
+
+        // Probes are only counted done once their result is out, so
+        // isDone() never runs ahead of poll()
+        if (!probe.empty()) {
+            probeFile(worker, std::move(probe));
+            worker.unflushed++;
+            if (worker.unflushed >= kFlushProbes) {
+                flush(worker);
+            }
+        } else {
+            crawlDirectory(worker, self, job);
+            flush(worker);
+            if (--m_outstanding == 0 && m_wake) {
+                m_wake();
+            }
+        }
+    }
+}
+
+void DirectoryCrawler::crawlDirectory(Worker& worker, size_t self, const Job& job)
+{
+    PROFILE_SCOPE_DETAIL("listDirectory", job.path);
+    int fd = ::open(job.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        // Gone by the time we got to it is not worth a message
+        if (errno != ENOENT) {
+            std::cerr << "Failed to open directory " << job.path << ": " << std::strerror(errno) << std::endl;
+        }
+        return;
+    }
+    m_directoryCount++;
+
+    bool descend = m_options.maxDepth < 0 || job.depth < m_options.maxDepth;
+    std::string path = job.path;
+    if (path.empty() || path.back() != '/') {
+        path += '/';
+    }
+    size_t prefixLength = path.size();
+
+    while (!m_stopping.load())
+    {
+        long count = syscall(SYS_getdents64, fd, worker.buffer.data(), worker.buffer.size());
+        if (count <= 0) {
+            if (count < 0) {
+                std::cerr << "Failed to list directory " << job.path << ": " << std::strerror(errno) << std::endl;
+            }
+            break;
+        }
+
+        for (long offset = 0; offset < count;)
+        {
+            const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(worker.buffer.data() + offset);
+            offset += entry->d_reclen;
+
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            if (isIgnored(name)) {
+                continue;
+            }
+
+            // Symlinks are resolved for files only, so a link cycle cannot trap the walk
+            unsigned char type = entry->d_type;
+            if (type == DT_UNKNOWN || type == DT_LNK) {
+                struct stat info;
+                m_statCount++;
+                if (fstatat(fd, name, &info, (type == DT_UNKNOWN) ? AT_SYMLINK_NOFOLLOW : 0) != 0) {
+                    continue;
+                }
+                if (S_ISREG(info.st_mode)) {
+                    type = DT_REG;
+                } else if (S_ISDIR(info.st_mode) && type == DT_UNKNOWN) {
+                    type = DT_DIR;
+                } else {
+                    continue;
+                }
+            }
+
+            if (type == DT_DIR) {
+                if (descend) {
+                    path.resize(prefixLength);
+                    path += name;
+                    worker.directories.push_back(path);
+                    push(self, Job{path, job.depth + 1});
+                }
+            } else if (type == DT_REG && (!m_filter || m_filter(name))) {
+                path.resize(prefixLength);
+                path += name;
+                if (m_options.probe) {
+                    pushProbe(self, path);
+                } else {
+                    worker.files.push_back(CrawledFile{path, ImageInfo()});
+                    m_fileCount++;
+                }
+            }
+        }
+
+        if (worker.files.size() >= kFlushEntries) {
+            flush(worker);
+        }
+    }
+
+    ::close(fd);
+}
+
+void DirectoryCrawler::probeFile(Worker& worker, std::string path)
+{
+    CrawledFile file;
+    if (m_options.probe && !ImageProbe::probe(path, file.info)) {
+        m_rejectedCount++;
+        return;
+    }
+    file.path = std::move(path);
+    worker.files.push_back(std::move(file));
+    m_fileCount++;
+}
+
+void DirectoryCrawler::flush(Worker& worker)
+{
+    if (worker.files.empty() && worker.directories.empty() && worker.unflushed == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_resultMutex);
+        m_files.insert(m_files.end(), std::make_move_iterator(worker.files.begin()),
+                       std::make_move_iterator(worker.files.end()));
+        m_directories.insert(m_directories.end(), std::make_move_iterator(worker.directories.begin()),
+                             std::make_move_iterator(worker.directories.end()));
+    }
+    worker.files.clear();
+    worker.directories.clear();
+    m_outstanding -= worker.unflushed;
+    worker.unflushed = 0;
+
+    if (m_wake) {
+        m_wake();
+    }
+}
@@ -0,0 +1,399 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    exif_reader.cpp                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "exif_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const uint16_t kTagBitsPerSample = 0x0102;
+const uint16_t kTagCompression = 0x0103;
+const uint16_t kTagPhotometric = 0x0106;
+const uint16_t kTagStripOffsets = 0x0111;
+const uint16_t kTagOrientation = 0x0112;
+const uint16_t kTagStripByteCounts = 0x0117;
+const uint16_t kTagSubIfds = 0x014A;
+const uint16_t kTagJpegOffset = 0x0201;
+const uint16_t kTagJpegLength = 0x0202;
+
+const uint16_t kTypeShort = 3;
+const uint16_t kTypeLong = 4;
+const uint16_t kTypeIfd = 13;
+
+const uint16_t kPhotometricCfa = 32803;
+const uint16_t kPhotometricLinearRaw = 34892;
+
+const int kMaxIfdEntries = 1024;
+const int kMaxIfdDepth = 4;
+const int kMaxJpegSegments = 256;
+
+// Bounds-checked pread window over a file
+struct FileWindow {
+    int fd;
+    uint64_t base;
+    uint64_t size;
+
+    bool read(uint64_t offset, void* target, size_t length) const
+    {
+        if (offset > size || length > size - offset) {
+            return false;
+        }
+        return ::pread(fd, target, length, static_cast<off_t>(base + offset)) == static_cast<ssize_t>(length);
+    }
+};
+
+struct TiffParser {
+    FileWindow window;
+    bool bigEndian;
+    ImageMetadata& metadata;
+    std::unordered_set<uint32_t> visited;
+
+    uint16_t u16(const unsigned char* p) const
+    {
+        return bigEndian ? static_cast<uint16_t>((p[0] << 8) | p[1])
+                         : static_cast<uint16_t>((p[1] << 8) | p[0]);
+    }
+
+    uint32_t u32(const unsigned char* p) const
+    {
+        return bigEndian ? (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]
+                         : (static_cast<uint32_t>(p[3]) << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+    }
+
+    // First value of an entry; values that do not fit in 4 bytes sit at an offset
+    uint32_t firstValue(const unsigned char* entry) const
+    {
+        uint16_t type = u16(entry + 2);
+        uint32_t count = u32(entry + 4);
+        const unsigned char* value = entry + 8;
+        unsigned char buffer[4];
+
+        size_t unit = (type == kTypeShort) ? 2 : 4;
+        if (unit * count > 4) {
+            if (!window.read(u32(entry + 8), buffer, unit)) {
+                return 0;
+            }
+            value = buffer;
+        }
+        return (type == kTypeShort) ? u16(value) : u32(value);
+    }
+
+    uint32_t parseIfd(uint32_t offset, int depth, bool primary)
+    {
+        if (depth > kMaxIfdDepth || offset == 0 || !visited.insert(offset).second) {
+            return 0;
+        }
+
+        unsigned char countBytes[2];
+        if (!window.read(offset, countBytes, 2)) {
+            return 0;
+        }
+        int count = u16(countBytes);
+        if (count == 0 || count > kMaxIfdEntries) {
+            return 0;
+        }
+
+        std::vector<unsigned char> entries(static_cast<size_t>(count) * 12 + 4);
+        if (!window.read(offset + 2, entries.data(), entries.size())) {
+            return 0;
+        }
+
+        uint32_t bits = 8, compression = 0, photometric = 0;
+        uint32_t stripOffset = 0, stripLength = 0, stripCount = 0;
+        uint32_t jpegOffset = 0, jpegLength = 0;
+        std::vector<uint32_t> subIfds;
+
+        for (int i = 0; i < count; i++)
+        {
+            const unsigned char* entry = entries.data() + i * 12;
+            uint16_t tag = u16(entry);
+
+            switch (tag) {
+                case kTagBitsPerSample: bits = firstValue(entry); break;
+                case kTagCompression: compression = firstValue(entry); break;
+                case kTagPhotometric: photometric = firstValue(entry); break;
+                case kTagStripOffsets: stripOffset = firstValue(entry); stripCount = u32(entry + 4); break;
+                case kTagStripByteCounts: stripLength = firstValue(entry); break;
+                case kTagJpegOffset: jpegOffset = firstValue(entry); break;
+                case kTagJpegLength: jpegLength = firstValue(entry); break;
+                case kTagOrientation:
+                    if (primary) {
+                        metadata.orientation = static_cast<int>(firstValue(entry));
+                    }
+                    break;
+                case kTagSubIfds: {
+                    uint16_t type = u16(entry + 2);
+                    uint32_t subCount = std::min<uint32_t>(u32(entry + 4), 8);
+                    if (type != kTypeLong && type != kTypeIfd) {
+                        break;
+                    }
+                    if (subCount == 1) {
+                        subIfds.push_back(u32(entry + 8));
+                    } else {
+                        std::vector<unsigned char> offsets(subCount * 4);
+                        if (window.read(u32(entry + 8), offsets.data(), offsets.size())) {
+                            for (uint32_t s = 0; s < subCount; s++) {
+                                subIfds.push_back(u32(offsets.data() + s * 4));
+                            }
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (jpegOffset && jpegLength) {
+            addPreview(jpegOffset, jpegLength);
+        }
+
+        // Single strip JPEG image data that is not the sensor data itself
+        bool jpegStrip = (compression == 6 || compression == 7) && stripCount == 1 && bits <= 8 &&
+                         photometric != kPhotometricCfa && photometric != kPhotometricLinearRaw;
+        if (jpegStrip && stripOffset && stripLength) {
+            addPreview(stripOffset, stripLength);
+        }
+
+        for (uint32_t subIfd : subIfds) {
+            parseIfd(subIfd, depth + 1, false);
+        }
+
+        return u32(entries.data() + count * 12);
+    }
+
+    void addPreview(uint32_t offset, uint32_t length)
+    {
+        EmbeddedPreview preview;
+        preview.offset = window.base + offset;
+        preview.length = length;
+
+        // Size from the stream's own SOF, which also weeds out non-JPEG strips
+        if (length > 4 && offset < window.size && length <= window.size - offset &&
+            readJpegSize(window.fd, preview.offset, length, preview.width, preview.height)) {
+            metadata.previews.push_back(preview);
+        }
+    }
+
+    static bool readJpegSize(int fd, uint64_t offset, uint32_t length, int& width, int& height);
+};
+
+// Walks marker segments to the first baseline/progressive SOF. Lossless and
+// 12-bit streams (RAW sensor data in CR2/DNG) are rejected here.
+bool TiffParser::readJpegSize(int fd, uint64_t offset, uint32_t length, int& width, int& height)
+{
+    unsigned char marker[4];
+    if (::pread(fd, marker, 2, static_cast<off_t>(offset)) != 2 || marker[0] != 0xFF || marker[1] != 0xD8) {
+        return false;
+    }
+
+    uint64_t position = 2;
+    for (int segment = 0; segment < kMaxJpegSegments && position + 4 <= length; segment++)
+    {
+        if (::pread(fd, marker, 4, static_cast<off_t>(offset + position)) != 4 || marker[0] != 0xFF) {
+            return false;
+        }
+
+        uint8_t type = marker[1];
+        uint32_t segmentLength = (marker[2] << 8) | marker[3];
+
+        if (type == 0xC0 || type == 0xC1 || type == 0xC2) {
+            unsigned char sof[5];
+            if (::pread(fd, sof, 5, static_cast<off_t>(offset + position + 4)) != 5 || sof[0] != 8) {
+                return false;
+            }
+            height = (sof[1] << 8) | sof[2];
+            width = (sof[3] << 8) | sof[4];
+            return width > 0 && height > 0;
+        }
+        if ((type >= 0xC3 && type <= 0xCF && type != 0xC4 && type != 0xC8 && type != 0xCC) || type == 0xDA) {
+            return false;
+        }
+
+        position += 2 + segmentLength;
+    }
+
+    return false;
+}
+
+bool parseTiff(int fd, uint64_t base, uint64_t size, ImageMetadata& metadata)
+{
+    unsigned char header[8];
+    FileWindow window{fd, base, size};
+    if (!window.read(0, header, sizeof(header))) {
+        return false;
+    }
+
+    bool bigEndian;
+    if (header[0] == 'I' && header[1] == 'I') {
+        bigEndian = false;
+    } else if (header[0] == 'M' && header[1] == 'M') {
+        bigEndian = true;
+    } else {
+        return false;
+    }
+
+    TiffParser parser{window, bigEndian, metadata, {}};
+
+    // 42 for TIFF/CR2/NEF/DNG/ARW, "RO"/"RS" for ORF, 0x55 for RW2
+    uint16_t magic = parser.u16(header + 2);
+    if (magic != 42 && magic != 0x4F52 && magic != 0x5352 && magic != 0x55) {
+        return false;
+    }
+
+    uint32_t offset = parser.u32(header + 4);
+    for (int ifd = 0; offset != 0 && ifd < 8; ifd++) {
+        offset = parser.parseIfd(offset, 0, ifd == 0);
+    }
+
+    return true;
+}
+
+bool parseJpeg(int fd, uint64_t fileSize, ImageMetadata& metadata)
+{
+    unsigned char marker[10];
+    if (::pread(fd, marker, 2, 0) != 2 || marker[0] != 0xFF || marker[1] != 0xD8) {
+        return false;
+    }
+
+    uint64_t position = 2;
+    for (int segment = 0; segment < kMaxJpegSegments && position + 4 <= fileSize; segment++)
+    {
+        if (::pread(fd, marker, 4, static_cast<off_t>(position)) != 4 || marker[0] != 0xFF) {
+            break;
+        }
+
+        uint8_t type = marker[1];
+        uint32_t segmentLength = (marker[2] << 8) | marker[3];
+
+        // EXIF always precedes the frame
+        if (type == 0xDA || (type >= 0xC0 && type <= 0xCF && type != 0xC4 && type != 0xC8 && type != 0xCC)) {
+            break;
+        }
+
+        if (type == 0xE1 && segmentLength > 8 &&
+            ::pread(fd, marker + 4, 6, static_cast<off_t>(position + 4)) == 6 &&
+            std::memcmp(marker + 4, "Exif\0\0", 6) == 0) {
+            // Offsets inside the EXIF block are relative to its TIFF header
+            return parseTiff(fd, position + 10, segmentLength - 8, metadata);
+        }
+
+        position += 2 + segmentLength;
+    }
+
+    return true;
+}
+
+} // namespace
+
+bool ExifReader::isRawPath(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".cr2" || ext == ".nef" || ext == ".nrw" || ext == ".dng" || ext == ".arw" ||
+           ext == ".orf" || ext == ".rw2" || ext == ".pef";
+}
+
+bool ExifReader::read(const std::string& path, ImageMetadata& metadata)
+{
+    metadata = ImageMetadata();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    bool parsed = ::fstat(fd, &st) == 0 && read(fd, static_cast<uint64_t>(st.st_size), metadata);
+    ::close(fd);
+    return parsed;
+}
+
+bool ExifReader::read(int fd, uint64_t fileSize, ImageMetadata& metadata)
+{
+    metadata = ImageMetadata();
+    bool parsed = parseJpeg(fd, fileSize, metadata) || parseTiff(fd, 0, fileSize, metadata);
+
+    if (metadata.orientation < 1 || metadata.orientation > 8) {
+        metadata.orientation = 1;
+    }
+
+    auto pixels = [](const EmbeddedPreview& preview) {
+        return static_cast<uint64_t>(preview.width) * preview.height;
+    };
+    std::sort(metadata.previews.begin(), metadata.previews.end(),
+              [&pixels](const EmbeddedPreview& a, const EmbeddedPreview& b) { return pixels(a) < pixels(b); });
+    metadata.previews.erase(std::unique(metadata.previews.begin(), metadata.previews.end(),
+                                        [](const EmbeddedPreview& a, const EmbeddedPreview& b) {
+                                            return a.offset == b.offset;
+                                        }),
+                            metadata.previews.end());
+
+    return parsed;
+}
+
+bool ExifReader::readPreview(const std::string& path, const EmbeddedPreview& preview, std::vector<unsigned char>& data)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    data.resize(preview.length);
+    bool ok = ::pread(fd, data.data(), data.size(), static_cast<off_t>(preview.offset)) ==
+              static_cast<ssize_t>(data.size());
+    ::close(fd);
+
+    return ok;
+}
+
+const EmbeddedPreview* ExifReader::findPreview(const ImageMetadata& metadata, int minSize)
+{
+    for (const EmbeddedPreview& preview : metadata.previews) {
+        if (std::max(preview.width, preview.height) >= minSize) {
+            return &preview;
+        }
+    }
+    return nullptr;
+}
+
+const EmbeddedPreview* ExifReader::largestPreview(const ImageMetadata& metadata)
+{
+    return metadata.previews.empty() ? nullptr : &metadata.previews.back();
+}
+
+int ExifReader::orientationQuarterTurns(int orientation)
+{
+    switch (orientation) {
+        case 3: case 4: return 2;
+        case 5: case 8: return 3;
+        case 6: case 7: return 1;
+        default: return 0;
+    }
+}
+
+float ExifReader::orientationRotation(int orientation)
+{
+    // glm::rotate is counter-clockwise, the quarter turns are clockwise
+    switch (orientationQuarterTurns(orientation)) {
+        case 1: return -90.0f;
+        case 2: return 180.0f;
+        case 3: return 90.0f;
+        default: return 0.0f;
+    }
+}
@@ -0,0 +1,308 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    folder_watcher.cpp                                            //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "folder_watcher.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+const uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE |
+                            IN_CREATE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+} // namespace
+
+FolderWatcher::FolderWatcher() 
+    : m_fd(-1),
+      m_notifyFd(-1),
+      m_armed(true),
+      m_notifierStopping(false)
+{
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        std::cerr << "Folder watching disabled: " << std::strerror(errno) << std::endl;
+    }
+}
+
+FolderWatcher::~FolderWatcher()
+{
+    stopNotifier();
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+void FolderWatcher::setWakeCallback(std::function<void()> callback)
+{
+    stopNotifier();
+    m_wake = std::move(callback);
+    if (!m_wake || m_fd < 0) {
+        return;
+    }
+
+    m_notifyFd = eventfd(0, EFD_CLOEXEC);
+    if (m_notifyFd < 0) {
+        std::cerr << "Failed to create eventfd: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    m_armed = true;
+    m_notifierStopping = false;
+    m_notifier = std::thread(&FolderWatcher::notifierLoop, this);
+}
+
+void FolderWatcher::stopNotifier()
+{
+    if (m_notifier.joinable()) {
+        m_notifierStopping = true;
+        uint64_t one = 1;
+        ssize_t written = ::write(m_notifyFd, &one, sizeof(one));
+        (void)written;
+        m_notifier.join();
+    }
+    if (m_notifyFd >= 0) {
+        ::close(m_notifyFd);
+        m_notifyFd = -1;
+    }
+}
+
+void FolderWatcher::notifierLoop()
+{
+    for (;;)
+    {
+        // Disarmed, only the eventfd is watched until poll() has run
+        pollfd fds[2] = {
+            {m_notifyFd, POLLIN, 0},
+            {m_armed.load() ? m_fd : -1, POLLIN, 0},
+        };
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            uint64_t value;
+            if (::read(m_notifyFd, &value, sizeof(value)) < 0 || m_notifierStopping.load()) {
+                return;
+            }
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            m_armed = false;
+            m_wake();
+        }
+    }
+}
+
+bool FolderWatcher::watch(const std::string& directory)
+{
+    if (m_fd < 0) {
+        return false;
+    }
+
+    int wd = inotify_add_watch(m_fd, directory.c_str(), kWatchMask);
+    if (wd < 0) {
+        // ENOSPC is fs.inotify.max_user_watches running out
+        std::cerr << "Failed to watch " << directory << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    m_directories[wd] = directory;
+    return true;
+}
+
+void FolderWatcher::unwatch(const std::string& directory)
+{
+    for (auto it = m_directories.begin(); it != m_directories.end();) {
+        if (isWithin(it->second, directory)) {
+            inotify_rm_watch(m_fd, it->first);
+            it = m_directories.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool FolderWatcher::isWatched(const std::string& directory) const
+{
+    for (const auto& entry : m_directories) {
+        if (entry.second == directory) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FolderWatcher::isWithin(const std::string& path, const std::string& directory)
+{
+    return path.size() >= directory.size() && path.compare(0, directory.size(), directory) == 0 &&
+           (path.size() == directory.size() || path[directory.size()] == '/');
+}
+
+void FolderWatcher::clear()
+{
+    for (const auto& entry : m_directories) {
+        inotify_rm_watch(m_fd, entry.first);
+    }
+    // Events still queued for the old folders carry unknown watch descriptors
+    // (the kernel does not reuse them right away) and are skipped by poll()
+    m_directories.clear();
+    m_moves.clear();
+}
+
+bool FolderWatcher::poll(std::vector<FolderChange>& changes, size_t maxBytes)
+{
+    if (m_fd < 0) {
+        return true;
+    }
+
+    // Index of the latest Changed/Removed entry per path; a later event on
+    // the same path supersedes it, renames cut the chain
+    std::unordered_map<std::string, size_t> latest;
+    size_t firstChange = changes.size();
+    bool overflowed = false;
+    bool drained = false;
+    size_t bytesRead = 0;
+
+    m_buffer.resize(64 * 1024);
+    while (bytesRead < maxBytes)
+    {
+        ssize_t count = ::read(m_fd, m_buffer.data(), m_buffer.size());
+        if (count <= 0) {
+            drained = true;
+            break;
+        }
+        bytesRead += static_cast<size_t>(count);
+
+        for (ssize_t offset = 0; offset < count;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(m_buffer.data() + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed = true;
+                continue;
+            }
+
+            auto directory = m_directories.find(event->wd);
+            if (directory == m_directories.end()) {
+                continue;
+            }
+
+            // A move inside the watched tree already came as a rename on the parent
+            if ((event->mask & IN_MOVE_SELF) && isWatched(parentOf(directory->second))) {
+                continue;
+            }
+
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                FolderChange change{FolderChange::Type::Removed, directory->second, std::string(), true};
+                if (event->mask & IN_IGNORED) {
+                    m_directories.erase(directory);
+                }
+                addChange(changes, latest, std::move(change));
+                continue;
+            }
+
+            if (event->len == 0) {
+                continue;
+            }
+
+            std::string path = directory->second + "/" + event->name;
+            bool isDirectory = (event->mask & IN_ISDIR) != 0;
+
+            if (event->mask & IN_MOVED_FROM) {
+                m_moves[event->cookie] = PendingMove{path, isDirectory};
+            } else if (event->mask & IN_MOVED_TO) {
+                auto move = m_moves.find(event->cookie);
+                if (move != m_moves.end()) {
+                    FolderChange change{FolderChange::Type::Renamed, path, move->second.path, isDirectory};
+                    m_moves.erase(move);
+                    if (isDirectory) {
+                        renameDirectory(change.oldPath, change.path);
+                    }
+                    latest.erase(change.oldPath);
+                    latest.erase(change.path);
+                    changes.push_back(std::move(change));
+                } else {
+                    addChange(changes, latest, FolderChange{FolderChange::Type::Changed, path, std::string(), isDirectory});
+                }
+            } else if (event->mask & IN_DELETE) {
+                addChange(changes, latest, FolderChange{FolderChange::Type::Removed, path, std::string(), isDirectory});
+            } else if (event->mask & IN_CLOSE_WRITE) {
+                addChange(changes, latest, FolderChange{FolderChange::Type::Changed, path, std::string(), false});
+            } else if ((event->mask & IN_CREATE) && isDirectory) {
+                // Files wait for IN_CLOSE_WRITE, directories are complete when created
+                addChange(changes, latest, FolderChange{FolderChange::Type::Changed, path, std::string(), true});
+            }
+        }
+    }
+
+    // With the queue empty an unpaired half is a move out of (or into) the
+    // watched folders; while events are still queued its partner may follow
+    if (drained) {
+        for (auto& move : m_moves) {
+            addChange(changes, latest, FolderChange{FolderChange::Type::Removed, move.second.path, std::string(), move.second.directory});
+        }
+        m_moves.clear();
+    }
+
+    // Superseded entries were left with an empty path
+    changes.erase(std::remove_if(changes.begin() + firstChange, changes.end(),
+                                 [](const FolderChange& change) { return change.path.empty(); }),
+                  changes.end());
+
+    if (m_notifier.joinable() && !m_armed.exchange(true)) {
+        uint64_t one = 1;
+        if (::write(m_notifyFd, &one, sizeof(one)) != sizeof(one)) {
+            std::cerr << "Failed to re-arm folder notifications: " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    return !overflowed;
+}
+
+void FolderWatcher::renameDirectory(const std::string& oldPath, const std::string& newPath)
+{
+    // Watches follow the inode, only the names they report under change
+    for (auto& entry : m_directories) {
+        if (isWithin(entry.second, oldPath)) {
+            entry.second = newPath + entry.second.substr(oldPath.size());
+        }
+    }
+}
+
+std::string FolderWatcher::parentOf(const std::string& path)
+{
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return std::string();
+    }
+    return path.substr(0, std::max<size_t>(slash, 1));
+}
+
+void FolderWatcher::addChange(std::vector<FolderChange>& changes, std::unordered_map<std::string, size_t>& latest,
+                              FolderChange change)
+{
+    auto it = latest.find(change.path);
+    if (it != latest.end()) {
+        changes[it->second].path.clear();
+        it->second = changes.size();
+    } else {
+        latest.emplace(change.path, changes.size());
+    }
+    changes.push_back(std::move(change));
+}
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    font.cpp                                                      //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "font.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb/stb_truetype.h>
+
+namespace {
+
+const int kFirstCodepoint = 32;
+const int kCodepointCount = 256 - kFirstCodepoint;
+const int kAtlasSize = 512;
+// Rows above the glyphs that hold the white texels
+const int kReservedRows = 2;
+
+const char* const kFontPaths[] = {
+    "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf",
+    "/usr/share/fonts/dejavu-sans-mono-fonts/DejaVuSansMono.ttf",
+    "/usr/share/fonts/TTF/DejaVuSansMono.ttf",
+    "/usr/share/fonts/truetype/liberation/LiberationMono-Regular.ttf",
+    "/usr/share/fonts/liberation-mono/LiberationMono-Regular.ttf",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/TTF/DejaVuSans.ttf",
+    "/usr/share/fonts/truetype/freefont/FreeMono.ttf",
+};
+
+bool fileExists(const std::string& path)
+{
+    std::ifstream file(path);
+    return file.good();
+}
+
+} // namespace
+
+Font::Font()
+    : m_atlasWidth(1), m_atlasHeight(1), m_ascent(0.0f), m_lineHeight(0.0f)
+{
+}
+
+std::string Font::findDefaultPath()
+{
+    const char* overridePath = std::getenv("PICASA_FONT");
+    if (overridePath && *overridePath) {
+        return overridePath;
+    }
+
+    for (const char* path : kFontPaths) {
+        if (fileExists(path)) {
+            return path;
+        }
+    }
+    return std::string();
+}
+
+bool Font::load(const std::string& path, float pixelHeight)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open font " << path << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    int offset = stbtt_GetFontOffsetForIndex(data.data(), 0);
+    stbtt_fontinfo info;
+    if (offset < 0 || !stbtt_InitFont(&info, data.data(), offset)) {
+        std::cerr << "Failed to read font " << path << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> atlas(static_cast<size_t>(kAtlasSize) * kAtlasSize, 0);
+    std::vector<stbtt_bakedchar> baked(kCodepointCount);
+    int used = stbtt_BakeFontBitmap(data.data(), offset, pixelHeight, atlas.data() + kReservedRows * kAtlasSize,
+                                    kAtlasSize, kAtlasSize - kReservedRows, kFirstCodepoint, kCodepointCount, baked.data());
+    if (used <= 0) {
+        std::cerr << "Font " << path << " does not fit the glyph atlas at " << pixelHeight << " px" << std::endl;
+        return false;
+    }
+    for (int y = 0; y < kReservedRows; y++) {
+        for (int x = 0; x < kReservedRows; x++) {
+            atlas[y * kAtlasSize + x] = 255;
+        }
+    }
+
+    int ascent = 0, descent = 0, lineGap = 0;
+    stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+    float scale = stbtt_ScaleForPixelHeight(&info, pixelHeight);
+    m_ascent = std::ceil(ascent * scale);
+    m_lineHeight = std::ceil((ascent - descent + lineGap) * scale);
+
+    const float size = static_cast<float>(kAtlasSize);
+    m_glyphs.resize(kCodepointCount);
+    for (int i = 0; i < kCodepointCount; i++) 
+    {
+        const stbtt_bakedchar& source = baked[i];
+        Glyph& glyph = m_glyphs[i];
+        glyph.u0 = source.x0 / size;
+        glyph.v0 = (source.y0 + kReservedRows) / size;
+        glyph.u1 = source.x1 / size;
+        glyph.v1 = (source.y1 + kReservedRows) / size;
+        glyph.xOffset = source.xoff;
+        glyph.yOffset = source.yoff;
+        glyph.width = static_cast<float>(source.x1 - source.x0);
+        glyph.height = static_cast<float>(source.y1 - source.y0);
+        glyph.advance = source.xadvance;
+    }
+
+    m_atlas.swap(atlas);
+    m_atlasWidth = kAtlasSize;
+    m_atlasHeight = kAtlasSize;
+    return true;
+}
+
+const Font::Glyph& Font::getGlyph(uint32_t codepoint) const
+{
+    if (codepoint < static_cast<uint32_t>(kFirstCodepoint) || codepoint >= 256u) {
+        codepoint = '?';
+    }
+    return m_glyphs[codepoint - kFirstCodepoint];
+}
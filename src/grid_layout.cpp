@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    grid_layout.cpp                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "grid_layout.h"
+#include <algorithm>
+#include <cmath>
+
+GridLayout::GridLayout()
+    : m_viewportWidth(0),
+      m_viewportHeight(0),
+      m_itemCount(0),
+      m_columns(1),
+      m_rows(0),
+      m_cellWidth(1.0f),
+      m_cellHeight(1.0f),
+      m_scroll(0.0f)
+{
+}
+
+void GridLayout::update(int viewportWidth, int viewportHeight, int cellSize, int itemCount) 
+{
+    m_viewportWidth = std::max(viewportWidth, 1);
+    m_viewportHeight = std::max(viewportHeight, 1);
+    m_itemCount = std::max(itemCount, 0);
+    
+    m_columns = std::max(1, m_viewportWidth / std::max(cellSize, 1));
+    m_rows = (m_itemCount + m_columns - 1) / m_columns;
+    
+    // Columns stretch to the full width, rows keep the cell size
+    m_cellWidth = static_cast<float>(m_viewportWidth) / m_columns;
+    m_cellHeight = static_cast<float>(std::max(cellSize, 1));
+    
+    clampScroll();
+}
+
+void GridLayout::scrollBy(float pixels) 
+{
+    m_scroll += pixels;
+    clampScroll();
+}
+
+void GridLayout::scrollToItem(int index) 
+{
+    if (index < 0 || index >= m_itemCount) {
+        return;
+    }
+    
+    float top = (index / m_columns) * m_cellHeight;
+    float bottom = top + m_cellHeight;
+    
+    if (top < m_scroll) {
+        m_scroll = top;
+    } else if (bottom > m_scroll + m_viewportHeight) {
+        m_scroll = bottom - m_viewportHeight;
+    }
+    
+    clampScroll();
+}
+
+void GridLayout::setScroll(float scroll) 
+{
+    m_scroll = scroll;
+    clampScroll();
+}
+
+float GridLayout::getMaxScroll() const 
+{
+    return std::max(0.0f, m_rows * m_cellHeight - m_viewportHeight);
+}
+
+void GridLayout::getVisibleRange(int marginRows, int& first, int& last) const 
+{
+    int firstRow = static_cast<int>(std::floor(m_scroll / m_cellHeight)) - marginRows;
+    int lastRow = static_cast<int>(std::ceil((m_scroll + m_viewportHeight) / m_cellHeight)) + marginRows;
+    
+    firstRow = std::max(firstRow, 0);
+    lastRow = std::min(lastRow, m_rows);
+    
+    first = std::min(firstRow * m_columns, m_itemCount);
+    last = std::min(lastRow * m_columns, m_itemCount);
+    if (last < first) {
+        last = first;
+    }
+}
+
+void GridLayout::getCellRect(int index, float& x, float& y, float& width, float& height) const 
+{
+    x = (index % m_columns) * m_cellWidth;
+    y = (index / m_columns) * m_cellHeight - m_scroll;
+    width = m_cellWidth;
+    height = m_cellHeight;
+}
+
+int GridLayout::pick(float x, float y) const 
+{
+    if (x < 0.0f || y < 0.0f || x >= m_viewportWidth || y >= m_viewportHeight) {
+        return -1;
+    }
+    
+    int col = static_cast<int>(x / m_cellWidth);
+    int row = static_cast<int>((y + m_scroll) / m_cellHeight);
+    if (col >= m_columns) {
+        return -1;
+    }
+    
+    int index = row * m_columns + col;
+    return (index < m_itemCount) ? index : -1;
+}
+
+void GridLayout::clampScroll() 
+{
+    m_scroll = std::max(0.0f, std::min(m_scroll, getMaxScroll()));
+}
@@ -0,0 +1,241 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    image_decoder.cpp                                             //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "image_decoder.h"
+#include "jpeg_decoder.h"
+#include "exif_reader.h"
+#include "input_file.h"
+#include "profiler.h"
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <mutex>
+
+#include <stb/stb_image.h>
+
+static void setupDecoder()
+{
+    static std::once_flag once;
+    std::call_once(once, []() { stbi_set_flip_vertically_on_load(true); });
+}
+
+static bool decodePreview(const std::string& path, const EmbeddedPreview& preview, int minSize, DecodedImage& image)
+{
+    std::vector<unsigned char> data;
+    int64_t start = Profiler::now();
+    if (!ExifReader::readPreview(path, preview, data)) {
+        return false;
+    }
+    IoStatistics::addRead(data.size(), Profiler::now() - start);
+    return JpegDecoder::decodeScaledMemory(data.data(), data.size(), minSize, image);
+}
+
+bool ImageDecoder::readInfo(const std::string& path, int& width, int& height, int& channels)
+{
+    if (ExifReader::isRawPath(path)) {
+        ImageMetadata metadata;
+        const EmbeddedPreview* preview = ExifReader::read(path, metadata) ? ExifReader::largestPreview(metadata) : nullptr;
+        if (!preview) {
+            return false;
+        }
+        width = preview->width;
+        height = preview->height;
+        channels = 3;
+        return true;
+    }
+
+    return stbi_info(path.c_str(), &width, &height, &channels) != 0;
+}
+
+bool ImageDecoder::decodeFile(const std::string& path, DecodedImage& image)
+{
+    PROFILE_SCOPE_DETAIL("decodeFile", path);
+    DecodeTimer timer;
+    setupDecoder();
+
+    if (ExifReader::isRawPath(path)) {
+        ImageMetadata metadata;
+        const EmbeddedPreview* preview = ExifReader::read(path, metadata) ? ExifReader::largestPreview(metadata) : nullptr;
+        if (!preview || !decodePreview(path, *preview, INT_MAX, image)) {
+            std::cerr << "No usable embedded preview in: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // One read into memory for stb instead of its own FILE* buffering
+    InputFile file;
+    if (!file.open(path)) {
+        std::cerr << "Failed to read image: " << path << std::endl;
+        return false;
+    }
+    if (file.size() > static_cast<size_t>(INT_MAX)) {
+        std::cerr << "Image file too large: " << path << std::endl;
+        return false;
+    }
+
+    int width, height, channels;
+    unsigned char* data = stbi_load_from_memory(file.data(), static_cast<int>(file.size()),
+                                                &width, &height, &channels, 0);
+    file.close();
+    if (!data) {
+        std::cerr << "Failed to decode image: " << path << std::endl;
+        std::cerr << "Reason: " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    // Grey + alpha has no matching GL format here, widen it to RGBA
+    int outChannels = (channels == 2) ? 4 : channels;
+    size_t pixelCount = static_cast<size_t>(width) * height;
+
+    image.width = width;
+    image.height = height;
+    image.channels = outChannels;
+
+    if (channels != 2) {
+        // stb allocates from the pixel pool (see texture.cpp), so its buffer is kept as is
+        image.pixels.adopt(data);
+        image.pixels.resize(pixelCount * channels);
+        return true;
+    }
+
+    if (!image.pixels.resize(pixelCount * outChannels)) {
+        std::cerr << "Out of pixel memory for: " << path << std::endl;
+        stbi_image_free(data);
+        return false;
+    }
+    for (size_t i = 0; i < pixelCount; i++) {
+        unsigned char grey = data[i * 2];
+        image.pixels[i * 4 + 0] = grey;
+        image.pixels[i * 4 + 1] = grey;
+        image.pixels[i * 4 + 2] = grey;
+        image.pixels[i * 4 + 3] = data[i * 2 + 1];
+    }
+
+    stbi_image_free(data);
+    return true;
+}
+
+bool ImageDecoder::decodeThumbnail(const std::string& path, int size, DecodedImage& thumbnail)
+{
+    PROFILE_SCOPE_DETAIL("decodeThumbnail", path);
+    DecodeTimer timer;
+    bool raw = ExifReader::isRawPath(path);
+    bool jpeg = JpegDecoder::isJpegPath(path);
+
+    ImageMetadata metadata;
+    if (raw || jpeg) {
+        ExifReader::read(path, metadata);
+    }
+
+    // An embedded preview that is big enough saves decoding the image itself;
+    // RAW files have nothing else we can decode
+    const EmbeddedPreview* preview = ExifReader::findPreview(metadata, size);
+    if (!preview && raw) {
+        preview = ExifReader::largestPreview(metadata);
+    }
+
+    DecodedImage image;
+    bool decoded = preview && decodePreview(path, *preview, size, image);
+
+    // JPEGs come out of the IDCT already close to the target size
+    if (!decoded && jpeg) {
+        decoded = JpegDecoder::decodeScaled(path, size, image);
+    }
+    if (!decoded && (raw || !decodeFile(path, image))) {
+        return false;
+    }
+
+    int thumbWidth, thumbHeight;
+    thumbnailDimensions(image.width, image.height, size, thumbWidth, thumbHeight);
+
+    if (!resize(image, thumbWidth, thumbHeight, thumbnail, Resampler::Filter::Lanczos3)) {
+        return false;
+    }
+
+    // Thumbnails are stored upright, the full image is rotated at draw time
+    rotate(thumbnail, ExifReader::orientationQuarterTurns(metadata.orientation));
+    return true;
+}
+
+bool ImageDecoder::resize(const DecodedImage& source, int width, int height, DecodedImage& target,
+                          Resampler::Filter filter)
+{
+    PROFILE_SCOPE("resize");
+    target.width = width;
+    target.height = height;
+    target.channels = source.channels;
+    if (!target.pixels.resize(static_cast<size_t>(width) * height * source.channels)) {
+        return false;
+    }
+
+    return Resampler::resize(source.pixels.data(), source.width, source.height, source.channels,
+                             target.pixels.data(), width, height, filter);
+}
+
+void ImageDecoder::rotate(DecodedImage& image, int quarterTurnsClockwise)
+{
+    int turns = ((quarterTurnsClockwise % 4) + 4) % 4;
+    if (turns == 0) {
+        return;
+    }
+
+    int width = image.width, height = image.height, channels = image.channels;
+    int rotatedWidth = (turns == 2) ? width : height;
+    int rotatedHeight = (turns == 2) ? height : width;
+    PixelBuffer rotated;
+    if (!rotated.resize(image.pixels.size())) {
+        std::cerr << "Out of pixel memory, image left unrotated" << std::endl;
+        return;
+    }
+
+    // Rows are stored bottom first, so work in top-down coordinates
+    for (int y = 0; y < rotatedHeight; y++) 
+    {
+        unsigned char* target = rotated.data() + static_cast<size_t>(rotatedHeight - 1 - y) * rotatedWidth * channels;
+        for (int x = 0; x < rotatedWidth; x++) 
+        {
+            int sourceX, sourceY;
+            if (turns == 1) {
+                sourceX = y;
+                sourceY = height - 1 - x;
+            } else if (turns == 2) {
+                sourceX = width - 1 - x;
+                sourceY = height - 1 - y;
+            } else {
+                sourceX = width - 1 - y;
+                sourceY = x;
+            }
+
+            const unsigned char* source = image.pixels.data() +
+                (static_cast<size_t>(height - 1 - sourceY) * width + sourceX) * channels;
+            std::copy(source, source + channels, target + x * channels);
+        }
+    }
+
+    image.pixels.swap(rotated);
+    image.width = rotatedWidth;
+    image.height = rotatedHeight;
+}
+
+void ImageDecoder::thumbnailDimensions(int width, int height, int size, int& thumbWidth, int& thumbHeight)
+{
+    if (width > height) 
+    {
+        thumbWidth = size;
+        thumbHeight = static_cast<int>(size * (static_cast<float>(height) / width));
+    } 
+    else 
+    {
+        thumbHeight = size;
+        thumbWidth = static_cast<int>(size * (static_cast<float>(width) / height));
+    }
+
+    thumbWidth = std::max(thumbWidth, 1);
+    thumbHeight = std::max(thumbHeight, 1);
+}
@@ -0,0 +1,379 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    image_prefetcher.cpp                                          //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "image_prefetcher.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+ImagePrefetcher::ImagePrefetcher()
+    : m_stopping(false),
+      m_generation(0),
+      m_imagesAhead(2),
+      m_byteBudget(512u * 1024 * 1024),
+      m_residentBytes(0),
+      m_maxPixels(SIZE_MAX),
+      m_maxDimension(INT_MAX),
+      m_previewSize(0),
+      m_previewPixels(SIZE_MAX)
+{
+}
+
+ImagePrefetcher::~ImagePrefetcher()
+{
+    stop();
+}
+
+void ImagePrefetcher::start(unsigned threadCount)
+{
+    if (!m_threads.empty()) {
+        return;
+    }
+
+    m_stopping = false;
+    for (unsigned i = 0; i < std::max(1u, threadCount); i++) {
+        m_threads.emplace_back(&ImagePrefetcher::workerLoop, this);
+    }
+}
+
+void ImagePrefetcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_slots.clear();
+    m_wanted.clear();
+    m_residentBytes = 0;
+}
+
+void ImagePrefetcher::setFiles(const std::vector<std::string>& paths)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paths = paths;
+    m_generation++;
+    m_wanted.clear();
+    m_slots.clear();
+    m_residentBytes = 0;
+}
+
+void ImagePrefetcher::appendFiles(const std::vector<std::string>& paths)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paths.insert(m_paths.end(), paths.begin(), paths.end());
+}
+
+void ImagePrefetcher::remapFiles(const std::vector<std::string>& paths, const std::vector<int>& remap)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paths = paths;
+    m_generation++;
+    m_wanted.clear();
+
+    // Jobs in flight belong to the old generation and are discarded, so
+    // only finished images carry over
+    std::unordered_map<int, Slot> slots;
+    for (auto& entry : m_slots)
+    {
+        int index = entry.first;
+        bool kept = entry.second.image && index < static_cast<int>(remap.size()) && remap[index] >= 0;
+        if (kept) {
+            slots[remap[index]] = std::move(entry.second);
+        } else {
+            m_residentBytes -= entry.second.bytes;
+        }
+    }
+    m_slots = std::move(slots);
+}
+
+void ImagePrefetcher::setRing(int imagesAhead, size_t byteBudget)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_imagesAhead = std::max(0, imagesAhead);
+    m_byteBudget = byteBudget;
+}
+
+void ImagePrefetcher::setImageLimits(size_t maxPixels, int maxDimension)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxPixels = maxPixels;
+    m_maxDimension = maxDimension;
+}
+
+void ImagePrefetcher::setPreviewSize(int size, size_t minPixels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_previewSize = size;
+    m_previewPixels = minPixels;
+}
+
+void ImagePrefetcher::update(int currentIndex, int direction, std::shared_ptr<const DecodedImage> current)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        int count = static_cast<int>(m_paths.size());
+        m_wanted.clear();
+        if (currentIndex < 0 || currentIndex >= count) {
+            dropUnwanted();
+            return;
+        }
+
+        int step = (direction < 0) ? -1 : 1;
+        int ahead = (count > 1) ? m_imagesAhead : 0;
+        int behind = (ahead > 0) ? std::max(1, ahead / 2) : 0;
+
+        // Interleave so the next image in the direction of travel comes first
+        for (int i = 1; i <= std::max(ahead, behind); i++) {
+            if (i <= ahead) {
+                m_wanted.push_back(((currentIndex + step * i) % count + count) % count);
+            }
+            if (i <= behind) {
+                m_wanted.push_back(((currentIndex - step * i) % count + count) % count);
+            }
+        }
+
+        // The current image always comes first: loadImage may be waiting on it
+        m_wanted.insert(m_wanted.begin(), currentIndex);
+
+        auto end = m_wanted.end();
+        for (auto it = m_wanted.begin(); it != end; ++it) {
+            end = std::remove(it + 1, end, *it);
+        }
+        m_wanted.erase(end, m_wanted.end());
+
+        dropUnwanted();
+
+        // Pixels the caller already decoded for the current image
+        Slot& slot = m_slots[currentIndex];
+        if (current && !slot.image && makeRoom(currentIndex, current->pixels.size())) {
+            slot.bytes = current->pixels.size();
+            slot.image = std::move(current);
+            slot.pending = false;
+            m_residentBytes += slot.bytes;
+        } else if (!slot.image && !slot.pending) {
+            m_slots.erase(currentIndex);
+        }
+    }
+    m_condition.notify_all();
+}
+
+std::shared_ptr<const DecodedImage> ImagePrefetcher::get(int index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_slots.find(index);
+    return (it != m_slots.end()) ? it->second.image : nullptr;
+}
+
+std::shared_ptr<const DecodedImage> ImagePrefetcher::getPreview(int index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_slots.find(index);
+    return (it != m_slots.end()) ? it->second.preview : nullptr;
+}
+
+bool ImagePrefetcher::isLoading(int index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (rankOf(index) < 0) {
+        return false;
+    }
+
+    auto it = m_slots.find(index);
+    return it == m_slots.end() || it->second.pending;
+}
+
+bool ImagePrefetcher::hasFailed(int index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (rankOf(index) < 0) {
+        return false;
+    }
+
+    auto it = m_slots.find(index);
+    return it != m_slots.end() && !it->second.pending && !it->second.image;
+}
+
+size_t ImagePrefetcher::getResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_residentBytes;
+}
+
+void ImagePrefetcher::workerLoop()
+{
+    Profiler::setThreadName("prefetch worker");
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;) 
+    {
+        int index = -1;
+        m_condition.wait(lock, [this, &index]() {
+            if (m_stopping) {
+                return true;
+            }
+            index = nextJob();
+            return index >= 0;
+        });
+
+        if (m_stopping) {
+            return;
+        }
+
+        unsigned generation = m_generation;
+        std::string path = m_paths[index];
+        int previewSize = m_previewSize;
+        size_t previewPixels = m_previewPixels;
+        lock.unlock();
+
+        // Size the job from the header before committing memory to it
+        int width, height, channels;
+        bool known = ImageDecoder::readInfo(path, width, height, channels);
+        lock.lock();
+
+        if (generation != m_generation) {
+            continue;
+        }
+        // update() moved the ring past it while the header was read
+        if (rankOf(index) < 0) {
+            m_slots.erase(index);
+            continue;
+        }
+
+        size_t bytes = static_cast<size_t>(width) * height * (channels == 2 ? 4 : channels);
+        bool tooLarge = known && (static_cast<size_t>(width) * height > m_maxPixels ||
+                                  std::max(width, height) > m_maxDimension);
+        if (!known || tooLarge || !makeRoom(index, bytes)) {
+            // Left as a failed slot until the ring moves
+            m_slots[index].pending = false;
+            if (m_wake) {
+                m_wake();
+            }
+            continue;
+        }
+
+        lock.unlock();
+        auto image = std::make_shared<DecodedImage>();
+        bool decoded = ImageDecoder::decodeFile(path, *image);
+
+        // Made here so flipping to the image never scales anything on the GL thread
+        std::shared_ptr<DecodedImage> preview;
+        if (decoded && previewSize > 0 && static_cast<size_t>(image->width) * image->height > previewPixels) {
+            int previewWidth, previewHeight;
+            ImageDecoder::thumbnailDimensions(image->width, image->height, previewSize, previewWidth, previewHeight);
+            preview = std::make_shared<DecodedImage>();
+            if (!ImageDecoder::resize(*image, previewWidth, previewHeight, *preview)) {
+                preview.reset();
+            }
+        }
+        lock.lock();
+
+        if (generation != m_generation) {
+            continue;
+        }
+
+        Slot& slot = m_slots[index];
+        slot.pending = false;
+        // The lock is held until the slot is filled, so a woken get() sees it
+        if (m_wake) {
+            m_wake();
+        }
+        if (slot.image || rankOf(index) < 0) {
+            continue;
+        }
+
+        bytes = image->pixels.size() + (preview ? preview->pixels.size() : 0);
+        if (decoded && makeRoom(index, bytes)) {
+            slot.bytes = bytes;
+            slot.image = std::move(image);
+            slot.preview = std::move(preview);
+            m_residentBytes += slot.bytes;
+        }
+    }
+}
+
+int ImagePrefetcher::nextJob()
+{
+    for (int index : m_wanted) {
+        auto it = m_slots.find(index);
+        if (it == m_slots.end()) {
+            m_slots[index].pending = true;
+            return index;
+        }
+    }
+    return -1;
+}
+
+int ImagePrefetcher::rankOf(int index) const
+{
+    auto it = std::find(m_wanted.begin(), m_wanted.end(), index);
+    return (it != m_wanted.end()) ? static_cast<int>(it - m_wanted.begin()) : -1;
+}
+
+bool ImagePrefetcher::makeRoom(int index, size_t bytes)
+{
+    // Only images in the ring may push others out
+    int rank = rankOf(index);
+    if (rank < 0) {
+        return false;
+    }
+
+    while (m_residentBytes + bytes > m_byteBudget) 
+    {
+        // Evict the resident entry farthest down the ring, if it is farther than us
+        int victim = -1;
+        int victimRank = rank;
+        for (const auto& entry : m_slots) {
+            if (!entry.second.image) {
+                continue;
+            }
+            int entryRank = rankOf(entry.first);
+            if (entryRank < 0) {
+                entryRank = static_cast<int>(m_wanted.size());
+            }
+            if (entryRank > victimRank) {
+                victim = entry.first;
+                victimRank = entryRank;
+            }
+        }
+
+        // The current image is on screen, not prefetched; alone it may exceed the budget
+        if (victim < 0) {
+            return rank == 0;
+        }
+
+        m_residentBytes -= m_slots[victim].bytes;
+        m_slots.erase(victim);
+    }
+
+    return true;
+}
+
+void ImagePrefetcher::dropUnwanted()
+{
+    // Failed or skipped slots get another chance whenever the ring moves
+    for (auto it = m_slots.begin(); it != m_slots.end();) {
+        bool failed = !it->second.pending && !it->second.image;
+        if (!it->second.pending && (failed || rankOf(it->first) < 0)) {
+            m_residentBytes -= it->second.bytes;
+            it = m_slots.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    image_probe.cpp                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "image_probe.h"
+#include "exif_reader.h"
+
+#include <stb/stb_image.h>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const int kMaxJpegSegments = 256;
+// Same limit stb_image decodes up to
+const int kMaxDimension = 1 << 24;
+
+// Served from the header when it covers the range, read from the file otherwise
+bool readAt(int fd, const unsigned char* header, size_t headerSize, uint64_t offset, unsigned char* target, size_t length)
+{
+    if (offset + length <= headerSize) {
+        std::memcpy(target, header + offset, length);
+        return true;
+    }
+    return ::pread(fd, target, length, static_cast<off_t>(offset)) == static_cast<ssize_t>(length);
+}
+
+// Walks the marker segments up to the frame header. Only 8-bit Huffman coded
+// frames are accepted; stb rejects arithmetic coding, and lossless,
+// hierarchical and 12-bit streams have no decoder here.
+bool readJpegFrame(int fd, const unsigned char* header, size_t headerSize, uint64_t fileSize, ImageInfo& info, bool& hasExif)
+{
+    unsigned char marker[6];
+    uint64_t position = 2;
+    for (int segment = 0; segment < kMaxJpegSegments && position + 4 <= fileSize; segment++)
+    {
+        if (!readAt(fd, header, headerSize, position, marker, 4) || marker[0] != 0xFF) {
+            return false;
+        }
+
+        uint8_t type = marker[1];
+        if (type == 0xFF) {
+            // Fill byte before the marker
+            position++;
+            continue;
+        }
+        if (type == 0xD8 || type == 0x01 || (type >= 0xD0 && type <= 0xD7)) {
+            position += 2;
+            continue;
+        }
+
+        uint32_t length = (marker[2] << 8) | marker[3];
+        if (length < 2 || type == 0xDA || type == 0xD9) {
+            return false;
+        }
+        hasExif = hasExif || type == 0xE1;
+
+        if (type >= 0xC0 && type <= 0xCF && type != 0xC4 && type != 0xC8 && type != 0xCC)
+        {
+            bool supported = type == 0xC0 || type == 0xC1 || type == 0xC2;
+            if (!supported || length < 8 || !readAt(fd, header, headerSize, position + 4, marker, 6) || marker[0] != 8) {
+                return false;
+            }
+            info.height = (marker[1] << 8) | marker[2];
+            info.width = (marker[3] << 8) | marker[4];
+            int components = marker[5];
+            if (components != 1 && components != 3 && components != 4) {
+                return false;
+            }
+            // CMYK and YCCK come out as RGB
+            info.channels = (components == 1) ? 1 : 3;
+            return true;
+        }
+
+        position += 2 + length;
+    }
+
+    return false;
+}
+
+bool readDimensions(int fd, const std::string& path, const unsigned char* header, size_t headerSize, ImageInfo& info)
+{
+    switch (info.format)
+    {
+        case ImageFormat::Jpeg: {
+            bool hasExif = false;
+            if (!readJpegFrame(fd, header, headerSize, info.fileSize, info, hasExif)) {
+                return false;
+            }
+            ImageMetadata metadata;
+            if (hasExif && ExifReader::read(fd, info.fileSize, metadata)) {
+                info.orientation = metadata.orientation;
+            }
+            return true;
+        }
+        case ImageFormat::Png:
+        case ImageFormat::Gif:
+        case ImageFormat::Bmp:
+            return stbi_info_from_memory(header, static_cast<int>(headerSize), &info.width, &info.height, &info.channels) != 0;
+        case ImageFormat::Raw: {
+            // Other TIFFs have no decoder here
+            ImageMetadata metadata;
+            if (!ExifReader::isRawPath(path) || !ExifReader::read(fd, info.fileSize, metadata)) {
+                return false;
+            }
+            const EmbeddedPreview* preview = ExifReader::largestPreview(metadata);
+            if (!preview) {
+                return false;
+            }
+            info.width = preview->width;
+            info.height = preview->height;
+            info.channels = 3;
+            info.orientation = metadata.orientation;
+            return true;
+        }
+        case ImageFormat::Unknown:
+            break;
+    }
+    return false;
+}
+
+} // namespace
+
+float ImageInfo::getUprightAspect() const
+{
+    if (width <= 0 || height <= 0) {
+        return 1.0f;
+    }
+    bool sideways = ExifReader::orientationQuarterTurns(orientation) % 2 != 0;
+    return sideways ? static_cast<float>(height) / width : static_cast<float>(width) / height;
+}
+
+double ImageInfo::getDecodeCost() const
+{
+    // Per pixel, relative to baseline JPEG; inflate and unfiltering make PNG the slowest
+    double pixels = static_cast<double>(width) * height;
+    switch (format) {
+        case ImageFormat::Png:
+            return pixels * 3.0;
+        case ImageFormat::Gif:
+            return pixels * 2.0;
+        case ImageFormat::Bmp:
+            return pixels * 0.5;
+        default:
+            return pixels;
+    }
+}
+
+bool ImageProbe::probe(const std::string& path, ImageInfo& info)
+{
+    info = ImageInfo();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    unsigned char header[kHeaderBytes];
+    struct stat st;
+    ssize_t bytes = (::fstat(fd, &st) == 0) ? ::pread(fd, header, sizeof(header), 0) : -1;
+
+    bool valid = false;
+    if (bytes > 0) {
+        info.fileSize = static_cast<uint64_t>(st.st_size);
+        info.format = sniff(header, static_cast<size_t>(bytes));
+        valid = readDimensions(fd, path, header, static_cast<size_t>(bytes), info) &&
+                info.width > 0 && info.height > 0 && info.width <= kMaxDimension && info.height <= kMaxDimension;
+    }
+    ::close(fd);
+
+    if (!valid) {
+        info.format = ImageFormat::Unknown;
+    }
+    if (info.orientation < 1 || info.orientation > 8) {
+        info.orientation = 1;
+    }
+    return valid;
+}
+
+ImageFormat ImageProbe::sniff(const unsigned char* data, size_t size)
+{
+    auto startsWith = [data, size](const char* magic, size_t length) {
+        return size >= length && std::memcmp(data, magic, length) == 0;
+    };
+
+    if (startsWith("\xFF\xD8\xFF", 3)) {
+        return ImageFormat::Jpeg;
+    }
+    if (startsWith("\x89PNG\r\n\x1A\n", 8)) {
+        return ImageFormat::Png;
+    }
+    if (startsWith("GIF87a", 6) || startsWith("GIF89a", 6)) {
+        return ImageFormat::Gif;
+    }
+    if (startsWith("BM", 2) && size >= 26) {
+        return ImageFormat::Bmp;
+    }
+    // TIFF containers: CR2, NEF, DNG, ARW, PEF; ORF and RW2 bend the magic number
+    if (startsWith("II*\0", 4) || startsWith("MM\0*", 4) || startsWith("IIRO", 4) || startsWith("IIRS", 4) ||
+        startsWith("IIU\0", 4)) {
+        return ImageFormat::Raw;
+    }
+    return ImageFormat::Unknown;
+}
+
+const char* ImageProbe::getFormatName(ImageFormat format)
+{
+    switch (format) {
+        case ImageFormat::Jpeg:
+            return "JPEG";
+        case ImageFormat::Png:
+            return "PNG";
+        case ImageFormat::Gif:
+            return "GIF";
+        case ImageFormat::Bmp:
+            return "BMP";
+        case ImageFormat::Raw:
+            return "RAW";
+        case ImageFormat::Unknown:
+            break;
+    }
+    return "unknown";
+}
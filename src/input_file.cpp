@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    input_file.cpp                                                //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "input_file.h"
+#include "profiler.h"
+
+#include <atomic>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<uint64_t> g_files(0);
+std::atomic<uint64_t> g_bytesRead(0);
+std::atomic<uint64_t> g_bytesReadAhead(0);
+std::atomic<int64_t> g_ioNs(0);
+std::atomic<int64_t> g_decodeNs(0);
+
+thread_local int64_t t_ioNs = 0;
+thread_local int t_decodeDepth = 0;
+
+bool readAll(int fd, unsigned char* target, size_t size)
+{
+    size_t done = 0;
+    while (done < size) {
+        ssize_t count = ::pread(fd, target + done, size - done, static_cast<off_t>(done));
+        if (count <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+} // namespace
+
+InputFile::InputFile()
+    : m_fd(-1), m_size(0)
+{
+}
+
+InputFile::~InputFile()
+{
+    close();
+}
+
+bool InputFile::open(const std::string& path, Access access)
+{
+    close();
+    PROFILE_SCOPE_DETAIL("read", path);
+    int64_t start = Profiler::now();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+
+    if (access == Access::Sequential) {
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        m_fd = fd;
+        m_size = size;
+        IoStatistics::addFile();
+        return true;
+    }
+
+    // Not zero filled, every byte is read over; a file truncated meanwhile fails here
+    std::unique_ptr<unsigned char[]> data(new unsigned char[size]);
+    bool read = readAll(fd, data.get(), size);
+    ::close(fd);
+    if (!read) {
+        return false;
+    }
+
+    m_data = std::move(data);
+    m_size = size;
+    IoStatistics::addFile();
+    IoStatistics::addRead(size, Profiler::now() - start);
+    return true;
+}
+
+void InputFile::close()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_data.reset();
+    m_size = 0;
+}
+
+size_t InputFile::read(uint64_t offset, unsigned char* target, size_t bytes)
+{
+    if (m_fd < 0) {
+        return 0;
+    }
+
+    int64_t start = Profiler::now();
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t count = ::pread(m_fd, target + done, bytes - done, static_cast<off_t>(offset + done));
+        if (count <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(count);
+    }
+    IoStatistics::addRead(done, Profiler::now() - start);
+    return done;
+}
+
+IoStats IoStatistics::get()
+{
+    IoStats stats;
+    stats.files = g_files.load(std::memory_order_relaxed);
+    stats.bytesRead = g_bytesRead.load(std::memory_order_relaxed);
+    stats.bytesReadAhead = g_bytesReadAhead.load(std::memory_order_relaxed);
+    stats.ioMs = g_ioNs.load(std::memory_order_relaxed) / 1e6;
+    stats.decodeMs = g_decodeNs.load(std::memory_order_relaxed) / 1e6;
+    return stats;
+}
+
+void IoStatistics::addFile()
+{
+    g_files.fetch_add(1, std::memory_order_relaxed);
+}
+
+void IoStatistics::addRead(uint64_t bytes, int64_t nanoseconds)
+{
+    g_bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    g_ioNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+    t_ioNs += nanoseconds;
+}
+
+void IoStatistics::addReadAhead(uint64_t bytes)
+{
+    g_bytesReadAhead.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+int64_t IoStatistics::getThreadIoTime()
+{
+    return t_ioNs;
+}
+
+DecodeTimer::DecodeTimer()
+    : m_start(0), m_ioStart(0), m_outermost(t_decodeDepth++ == 0)
+{
+    if (m_outermost) {
+        m_start = Profiler::now();
+        m_ioStart = t_ioNs;
+    }
+}
+
+DecodeTimer::~DecodeTimer()
+{
+    t_decodeDepth--;
+    if (m_outermost) {
+        int64_t elapsed = Profiler::now() - m_start - (t_ioNs - m_ioStart);
+        g_decodeNs.fetch_add(elapsed > 0 ? elapsed : 0, std::memory_order_relaxed);
+    }
+}
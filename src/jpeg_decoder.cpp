@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    jpeg_decoder.cpp                                              //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "jpeg_decoder.h"
+#include "input_file.h"
+
+#include <iostream>
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <jpeglib.h>
+#include <jerror.h>
+
+namespace {
+
+struct ErrorManager {
+    jpeg_error_mgr base;
+    jmp_buf jump;
+};
+
+void errorExit(j_common_ptr cinfo)
+{
+    ErrorManager* manager = reinterpret_cast<ErrorManager*>(cinfo->err);
+    longjmp(manager->jump, 1);
+}
+
+void outputMessage(j_common_ptr)
+{
+    // Corrupt data warnings are not worth a line per thumbnail
+}
+
+// Feeds libjpeg from an InputFile in chunks. Running out of data is an
+// error rather than libjpeg's usual padding, so a file truncated while it
+// is decoded fails instead of filling the rest grey.
+struct FileSource {
+    jpeg_source_mgr base;
+    InputFile* file;
+    uint64_t position;
+    JOCTET buffer[64 * 1024];
+};
+
+void initSource(j_decompress_ptr)
+{
+}
+
+boolean fillInputBuffer(j_decompress_ptr cinfo)
+{
+    FileSource* source = reinterpret_cast<FileSource*>(cinfo->src);
+    size_t count = source->file->read(source->position, source->buffer, sizeof(source->buffer));
+    if (count == 0) {
+        ERREXIT(cinfo, JERR_INPUT_EOF);
+    }
+    source->position += count;
+    source->base.next_input_byte = source->buffer;
+    source->base.bytes_in_buffer = count;
+    return TRUE;
+}
+
+void skipInputData(j_decompress_ptr cinfo, long count)
+{
+    FileSource* source = reinterpret_cast<FileSource*>(cinfo->src);
+    if (count <= 0) {
+        return;
+    }
+    size_t skip = static_cast<size_t>(count);
+    if (skip <= source->base.bytes_in_buffer) {
+        source->base.next_input_byte += skip;
+        source->base.bytes_in_buffer -= skip;
+        return;
+    }
+    source->position += skip - source->base.bytes_in_buffer;
+    source->base.bytes_in_buffer = 0;
+}
+
+void termSource(j_decompress_ptr)
+{
+}
+
+void fileSource(j_decompress_ptr cinfo, FileSource& source, InputFile& file)
+{
+    source.base.init_source = initSource;
+    source.base.fill_input_buffer = fillInputBuffer;
+    source.base.skip_input_data = skipInputData;
+    source.base.resync_to_restart = jpeg_resync_to_restart;
+    source.base.term_source = termSource;
+    source.base.next_input_byte = nullptr;
+    source.base.bytes_in_buffer = 0;
+    source.file = &file;
+    source.position = 0;
+    cinfo->src = &source.base;
+}
+
+} // namespace
+
+bool JpegDecoder::isJpegPath(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".jpg" || ext == ".jpeg";
+}
+
+bool JpegDecoder::decodeScaled(const std::string& path, int minSize, DecodedImage& image)
+{
+    InputFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    bool decoded = decodeScaledMemory(file.data(), file.size(), minSize, image);
+    if (!decoded) {
+        std::cerr << "Failed to decode JPEG: " << path << std::endl;
+    }
+    return decoded;
+}
+
+bool JpegDecoder::decodeScaledMemory(const unsigned char* data, size_t size, int minSize, DecodedImage& image)
+{
+    DecodeTimer timer;
+    jpeg_decompress_struct cinfo;
+    ErrorManager error;
+    cinfo.err = jpeg_std_error(&error.base);
+    error.base.error_exit = errorExit;
+    error.base.output_message = outputMessage;
+
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, data, static_cast<unsigned long>(size));
+    jpeg_read_header(&cinfo, TRUE);
+
+    // CMYK and friends stay on the stb path
+    if (cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    unsigned longSide = std::max(cinfo.image_width, cinfo.image_height);
+    unsigned denom = 8;
+    while (denom > 1 && (longSide + denom - 1) / denom < static_cast<unsigned>(minSize)) {
+        denom /= 2;
+    }
+
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = denom;
+    cinfo.out_color_space = (cinfo.num_components == 1) ? JCS_GRAYSCALE : JCS_RGB;
+    cinfo.dct_method = JDCT_ISLOW;
+    cinfo.do_fancy_upsampling = FALSE;
+
+    jpeg_start_decompress(&cinfo);
+
+    image.width = static_cast<int>(cinfo.output_width);
+    image.height = static_cast<int>(cinfo.output_height);
+    image.channels = cinfo.output_components;
+
+    size_t stride = static_cast<size_t>(image.width) * image.channels;
+    if (!image.pixels.resize(stride * image.height)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    // Bottom row first, like stbi with vertical flip
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = image.pixels.data() + (image.height - 1 - cinfo.output_scanline) * stride;
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+    return true;
+}
+
+bool JpegDecoder::decodeRows(const std::string& path, const RowCallback& onRow, const std::atomic<bool>* cancel)
+{
+    // Read in chunks as the rows are decoded, so huge files never sit in memory whole
+    InputFile file;
+    if (!file.open(path, InputFile::Access::Sequential)) {
+        return false;
+    }
+    DecodeTimer timer;
+
+    jpeg_decompress_struct cinfo;
+    ErrorManager error;
+    cinfo.err = jpeg_std_error(&error.base);
+    error.base.error_exit = errorExit;
+    error.base.output_message = outputMessage;
+
+    // Declared before setjmp: libjpeg errors longjmp past anything constructed later
+    std::vector<unsigned char> buffer;
+    std::unique_ptr<FileSource> source(new FileSource());
+
+    if (setjmp(error.jump)) {
+        std::cerr << "Failed to decode JPEG: " << path << std::endl;
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    fileSource(&cinfo, *source, file);
+    jpeg_read_header(&cinfo, TRUE);
+
+    if (cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    cinfo.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&cinfo);
+
+    buffer.resize(static_cast<size_t>(cinfo.output_width) * cinfo.output_components);
+    bool cancelled = false;
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+        if (cancel && cancel->load()) {
+            cancelled = true;
+            break;
+        }
+
+        int y = static_cast<int>(cinfo.output_scanline);
+        JSAMPROW row = buffer.data();
+        jpeg_read_scanlines(&cinfo, &row, 1);
+        onRow(buffer.data(), y);
+    }
+
+    if (cancelled) {
+        jpeg_abort_decompress(&cinfo);
+    } else {
+        jpeg_finish_decompress(&cinfo);
+    }
+    jpeg_destroy_decompress(&cinfo);
+
+    return !cancelled;
+}
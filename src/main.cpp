@@ -10,8 +10,15 @@
 #include "shader.h"
 #include "texture.h"
 #include "ui.h"
+#include "texture_cache.h"
+#include "tiled_image.h"
+#include "profiler.h"
+#include "pixel_pool.h"
 #include <iostream>
+#include <cstdio>
 #include <filesystem>
+#include <algorithm>
+#include <cstdlib>
 
 namespace fs = std::filesystem;
 
@@ -19,7 +26,7 @@ static PicasaApp* g_appInstance = nullptr;
 
 class PicasaAppWithUI : public PicasaApp {
 public:
-    PicasaAppWithUI() : PicasaApp(), m_uiManager(nullptr), m_infoLabel(nullptr) {
+    PicasaAppWithUI() : PicasaApp(), m_uiManager(nullptr), m_infoLabel(nullptr), m_statsLabel(nullptr) {
     }
     
     ~PicasaAppWithUI() {
@@ -33,7 +40,9 @@ public:
         }
         
         m_uiManager = new UIManager();
-        m_uiManager->initialize(width, height);
+        if (!m_uiManager->initialize(width, height, *m_shaderManager)) {
+            std::cerr << "UI disabled" << std::endl;
+        }
         
         setupUI();
         
@@ -44,17 +53,30 @@ public:
     {
         while (!glfwWindowShouldClose(m_window)) 
         {
-            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT);
-            
-            render();
-            
-            m_uiManager->render();
+            waitForEvents();
             
-            updateInfoLabel();
+            beginFrame();
+            update();
             
-            glfwSwapBuffers(m_window);
-            glfwPollEvents();
+            if (m_needsRedraw) 
+            {
+                m_needsRedraw = false;
+                glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+                
+                render();
+                
+                updateInfoLabel();
+                {
+                    PROFILE_SCOPE("ui");
+                    GpuScope gpu(m_gpuTimer.get(), "ui");
+                    m_uiManager->render();
+                }
+                
+                PROFILE_SCOPE("swap");
+                glfwSwapBuffers(m_window);
+            }
+            endFrame();
         }
     }
     
@@ -67,6 +89,7 @@ public:
             glfwGetCursorPos(window, &xpos, &ypos);
             
             if (app->m_uiManager->handleMouseClick(xpos, ypos)) {
+                app->requestRedraw();
                 return;
             }
         }
@@ -78,7 +101,9 @@ public:
         PicasaAppWithUI* app = static_cast<PicasaAppWithUI*>(g_appInstance);
         if (!app) return;
         
-        app->m_uiManager->handleMouseMove(xpos, ypos);
+        if (app->m_uiManager->handleMouseMove(xpos, ypos)) {
+            app->requestRedraw();
+        }
         
         PicasaApp::cursorPosCallback(window, xpos, ypos);
     }
@@ -95,6 +120,7 @@ public:
 private:
     UIManager* m_uiManager;
     Label* m_infoLabel;
+    Label* m_statsLabel;
     Button* m_prevButton;
     Button* m_nextButton;
     Button* m_rotateButton;
@@ -106,6 +132,10 @@ private:
         m_infoLabel = new Label(10, 10, "No image loaded");
         m_uiManager->addElement(m_infoLabel);
         
+        m_statsLabel = new Label(10, 30, "");
+        m_statsLabel->setVisible(false);
+        m_uiManager->addElement(m_statsLabel);
+        
         m_prevButton = new Button(10, m_height - 50, 80, 40, "Previous");
         m_prevButton->setCallback([this]() { previousImage(); });
         m_uiManager->addElement(m_prevButton);
@@ -139,24 +169,56 @@ private:
         m_uiManager->addElement(m_toggleViewButton);
     }
     
+    // Formatted into stack buffers; the labels only re-layout when the text changed
     void updateInfoLabel() {
-        if (m_currentTexture) {
-            std::string info = "Image: ";
-            
-            size_t lastSlash = m_current_image_path.find_last_of("/\\");
-            std::string filename = (lastSlash != std::string::npos) ? 
-                m_current_image_path.substr(lastSlash + 1) : m_current_image_path;
-                
-            info += filename + " | ";
-            info += std::to_string(m_currentTexture->getWidth()) + "x" + 
-                    std::to_string(m_currentTexture->getHeight()) + " | ";
-            info += "Zoom: " + std::to_string(static_cast<int>(m_scale * 100)) + "% | ";
-            info += "Rotation: " + std::to_string(static_cast<int>(m_rotation)) + "°";
-            
-            m_infoLabel->setText(info);
-        } else {
+        m_statsLabel->setVisible(m_showStats);
+        if (m_showStats) {
+            char stats[2048];
+            formatStatsText(stats, sizeof(stats), true);
+            m_statsLabel->setText(stats);
+        }
+        
+        int imageWidth, imageHeight;
+        if (!getCurrentImageSize(imageWidth, imageHeight)) {
             m_infoLabel->setText("No image loaded");
+            return;
         }
+        
+        char info[1024];
+        size_t length = 0;
+        auto append = [&](const char* format, auto... args) {
+            if (length < sizeof(info)) {
+                int written = std::snprintf(info + length, sizeof(info) - length, format, args...);
+                length += (written > 0) ? static_cast<size_t>(written) : 0;
+            }
+        };
+        
+        size_t lastSlash = m_current_image_path.find_last_of("/\\");
+        const char* filename = m_current_image_path.c_str() + ((lastSlash != std::string::npos) ? lastSlash + 1 : 0);
+        append("Image: %s | %dx%d | ", filename, imageWidth, imageHeight);
+        if (m_tiledImage) {
+            append("%s", m_tiledImage->isComplete() ? "Tiled | " : "Tiling... | ");
+        } else if (m_showingPreview || !m_currentTexture) {
+            append("%s", "Loading... | ");
+        }
+        append("Zoom: %d%% | Rotation: %d°", static_cast<int>(m_scale * 100), static_cast<int>(m_rotation));
+        
+        const LoadTimings& timings = getLoadTimings();
+        if (timings.firstPixelMs >= 0.0) {
+            append(" | First pixel: %d ms", static_cast<int>(timings.firstPixelMs));
+        }
+        if (timings.fullResolutionMs >= 0.0 && timings.fromPreview) {
+            append(", full: %d ms", static_cast<int>(timings.fullResolutionMs));
+        }
+        
+        if (m_textureCache) {
+            const TextureCache::Stats& stats = m_textureCache->getStats();
+            append(" | Cache: %llu hits, %llu misses, %zu/%zu MB",
+                   static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+                   stats.residentBytes / (1024 * 1024), stats.budgetBytes / (1024 * 1024));
+        }
+        
+        m_infoLabel->setText(info);
     }
 };
 
@@ -164,15 +226,97 @@ int main(int argc, char* argv[])
 {
     PicasaAppWithUI app;
     
+    std::string path;
+    bool useThumbnailCache = true;
+    bool useShaderCache = true;
+    bool hashThumbnails = false;
+    unsigned workerThreads = 0;
+    int gridMarginRows = 2;
+    int prefetchAhead = 2;
+    size_t prefetchMegabytes = 512;
+    size_t textureMegabytes = 256;
+    size_t uploadMegabytes = 16;
+    size_t pixelPoolMegabytes = 4096;
+    TextureCompression compression = TextureCompression::Bptc;
+    CrawlOptions crawlOptions;
+    std::string tracePath;
+    bool showStats = false;
+    
+    for (int i = 1; i < argc; i++) 
+    {
+        std::string arg = argv[i];
+        
+        if (arg == "--no-thumbnail-cache") {
+            useThumbnailCache = false;
+        } else if (arg == "--no-shader-cache") {
+            useShaderCache = false;
+        } else if (arg == "--hash-thumbnails") {
+            hashThumbnails = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            workerThreads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--grid-margin" && i + 1 < argc) {
+            gridMarginRows = std::atoi(argv[++i]);
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            prefetchAhead = std::atoi(argv[++i]);
+        } else if (arg == "--texture-budget-mb" && i + 1 < argc) {
+            textureMegabytes = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--upload-mb" && i + 1 < argc) {
+            uploadMegabytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--compression" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "none") {
+                compression = TextureCompression::None;
+            } else if (mode == "bc1") {
+                compression = TextureCompression::S3tc;
+            } else if (mode == "bc7") {
+                compression = TextureCompression::Bptc;
+            } else {
+                std::cerr << "Unknown compression: " << mode << std::endl;
+            }
+        } else if (arg == "--prefetch-mb" && i + 1 < argc) {
+            prefetchMegabytes = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--pixel-pool-mb" && i + 1 < argc) {
+            pixelPoolMegabytes = static_cast<size_t>(std::max(64, std::atoi(argv[++i])));
+        } else if (arg == "--depth" && i + 1 < argc) {
+            crawlOptions.maxDepth = std::atoi(argv[++i]);
+        } else if (arg == "--ignore" && i + 1 < argc) {
+            crawlOptions.ignorePatterns.push_back(argv[++i]);
+        } else if (arg == "--no-probe") {
+            crawlOptions.probe = false;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--stats") {
+            showStats = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+        } else {
+            path = arg;
+        }
+    }
+    
+    app.setThumbnailCacheOptions(useThumbnailCache, hashThumbnails);
+    app.setShaderCacheEnabled(useShaderCache);
+    app.setWorkerThreads(workerThreads);
+    app.setGridMarginRows(gridMarginRows);
+    app.setPrefetchOptions(prefetchAhead, prefetchMegabytes * 1024 * 1024);
+    app.setTextureBudget(textureMegabytes * 1024 * 1024);
+    app.setUploadBudget(uploadMegabytes * 1024 * 1024);
+    app.setTextureCompression(compression);
+    app.setCrawlOptions(crawlOptions);
+    PixelPool::setCeiling(pixelPoolMegabytes * 1024 * 1024);
+    
+    // Started before initialize() so startup shows up in the trace
+    if (!tracePath.empty()) {
+        Profiler::startTrace(tracePath);
+    }
+    
     if (!app.initialize(1024, 768, "OpenGL Picasa Demo")) {
         std::cerr << "Failed to initialize application" << std::endl;
         return -1;
     }
     
-    if (argc > 1) 
+    if (!path.empty()) 
     {
-        std::string path = argv[1];
-        
         fs::path fs_path(path);
         if (fs::is_directory(fs_path)) 
         {
@@ -189,7 +333,12 @@ int main(int argc, char* argv[])
         }
     }
     
+    app.setShowStats(showStats);
     app.run();
     
+    if (!tracePath.empty()) {
+        Profiler::stopTrace();
+    }
+    
     return 0;
 }
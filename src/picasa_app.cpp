@@ -8,14 +8,29 @@
 
 #include "picasa_app.h"
 #include "shader.h"
+#include "shader_manager.h"
 #include "texture.h"
+#include "image_decoder.h"
+#include "thumbnail_cache.h"
+#include "thumbnail_loader.h"
+#include "image_prefetcher.h"
+#include "texture_cache.h"
+#include "tiled_image.h"
+#include "jpeg_decoder.h"
+#include "exif_reader.h"
+#include "upload_stream.h"
+#include "input_file.h"
+#include "pixel_pool.h"
+#include "uniform_buffer.h"
+#include "folder_watcher.h"
+#include "profiler.h"
 
+#include <cstdio>
 #include <iostream>
-#include <filesystem>
 #include <algorithm>
 #include <cmath>
-
-namespace fs = std::filesystem;
+#include <cstddef>
+#include <unordered_set>
 
 static PicasaApp* g_appInstance = nullptr;
 
@@ -23,16 +38,49 @@ PicasaApp::PicasaApp()
     : m_window(nullptr), 
       m_width(800), 
       m_height(600),
+      m_useShaderCache(true),
       m_vao(0), 
       m_vbo(0), 
       m_ebo(0),
       m_currentIndex(0),
+      m_textureBudget(256u * 1024 * 1024),
+      m_imageWidth(0),
+      m_imageHeight(0),
+      m_showingPreview(false),
+      m_pendingIndex(-1),
+      m_uploadBytesPerFrame(16u * 1024 * 1024),
+      m_progressivePixels(2u * 1024 * 1024),
+      m_loadStartTime(0.0),
+      m_maxTextureSize(8192),
+      m_maxTexturePixels(64u * 1024 * 1024),
       m_scale(1.0f),
       m_offset(0.0f, 0.0f),
       m_rotation(0.0f),
+      m_uprightRotation(0.0f),
       m_isDragging(false),
       m_showThumbnails(true),
-      m_thumbnailSize(150)
+      m_thumbnailSize(150),
+      m_gridMarginRows(2),
+      m_windowFirst(0),
+      m_windowLast(0),
+      m_thumbnailWindowDirty(false),
+      m_lastCrawlApply(0.0),
+      m_rescanning(false),
+      m_thumbnailShader(nullptr),
+      m_thumbnailVao(0),
+      m_instanceVbo(0),
+      m_instanceCapacity(0),
+      m_useThumbnailCache(true),
+      m_hashThumbnails(false),
+      m_textureCompression(TextureCompression::Bptc),
+      m_workerThreads(0),
+      m_maxThumbnailUploadsPerFrame(32),
+      m_prefetchAhead(2),
+      m_prefetchBudget(512u * 1024 * 1024),
+      m_navigationDirection(1),
+      m_showStats(false),
+      m_needsRedraw(true),
+      m_wakePending(false)
 {
     g_appInstance = this;
 }
@@ -48,6 +96,31 @@ PicasaApp::~PicasaApp()
     if (m_ebo != 0) {
         glDeleteBuffers(1, &m_ebo);
     }
+    if (m_thumbnailVao != 0) {
+        glDeleteVertexArrays(1, &m_thumbnailVao);
+    }
+    if (m_instanceVbo != 0) {
+        glDeleteBuffers(1, &m_instanceVbo);
+    }
+
+    // Workers may still read from the cache mapping, and all of them wake
+    // the loop through GLFW, so they go before glfwTerminate()
+    m_folderWatcher.reset();
+    m_crawler.reset();
+    m_thumbnailLoader.reset();
+    m_prefetcher.reset();
+
+    // GL objects have to go before the context does
+    m_thumbnailAtlas.reset();
+    m_tiledImage.reset();
+    m_uploadStream.reset();
+    m_pendingTexture.reset();
+    m_currentTexture.reset();
+    m_textureCache.reset();
+    m_shaderManager.reset();
+    m_frameUniforms.reset();
+    m_thumbnailCache.reset();
+    m_gpuTimer.reset();
 
     glfwTerminate();
 }
@@ -56,6 +129,8 @@ bool PicasaApp::initialize(int width, int height, const std::string& title)
 {
     m_width = width;
     m_height = height;
+    m_title = title;
+    Profiler::setThreadName("main");
     
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -76,6 +151,7 @@ bool PicasaApp::initialize(int width, int height, const std::string& title)
     glfwMakeContextCurrent(m_window);
     
     glfwSetFramebufferSizeCallback(m_window, framebufferSizeCallback);
+    glfwSetWindowRefreshCallback(m_window, windowRefreshCallback);
     glfwSetKeyCallback(m_window, keyCallback);
     glfwSetMouseButtonCallback(m_window, mouseButtonCallback);
     glfwSetCursorPosCallback(m_window, cursorPosCallback);
@@ -91,63 +167,589 @@ bool PicasaApp::initialize(int width, int height, const std::string& title)
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_maxTextureSize);
+    
+    while (!Texture::isCompressionSupported(m_textureCompression)) {
+        m_textureCompression = static_cast<TextureCompression>(static_cast<int>(m_textureCompression) - 1);
+    }
+    
     setupShaders();
     setupGeometry();
     
+    if (m_useThumbnailCache) {
+        m_thumbnailCache = std::make_unique<ThumbnailCache>();
+        m_thumbnailCache->setHashContents(m_hashThumbnails);
+        if (!m_thumbnailCache->open(ThumbnailCache::defaultDirectory())) {
+            std::cerr << "Thumbnail cache disabled" << std::endl;
+            m_thumbnailCache.reset();
+        }
+    }
+    
+    m_uploadStream = std::make_unique<UploadStream>();
+    if (!m_uploadStream->initialize(m_uploadBytesPerFrame)) {
+        m_uploadStream.reset();
+    }
+    
+    m_thumbnailAtlas = std::make_unique<ThumbnailAtlas>();
+    if (!m_thumbnailAtlas->initialize(m_thumbnailSize, 256, m_textureCompression)) {
+        m_thumbnailAtlas.reset();
+    } else {
+        m_thumbnailAtlas->setUploadStream(m_uploadStream.get());
+    }
+    
+    m_thumbnailLoader = std::make_unique<ThumbnailLoader>();
+    m_thumbnailLoader->setWakeCallback([this]() { wake(); });
+    m_thumbnailLoader->start(m_workerThreads);
+    
+    m_textureCache = std::make_unique<TextureCache>(m_textureBudget);
+    
+    m_prefetcher = std::make_unique<ImagePrefetcher>();
+    m_prefetcher->setRing(m_prefetchAhead, m_prefetchBudget);
+    m_prefetcher->setImageLimits(m_maxTexturePixels, m_maxTextureSize);
+    m_prefetcher->setPreviewSize(m_thumbnailSize, m_progressivePixels);
+    m_prefetcher->setWakeCallback([this]() { wake(); });
+    m_prefetcher->start();
+    
+    m_folderWatcher = std::make_unique<FolderWatcher>();
+    if (!m_folderWatcher->isActive()) {
+        m_folderWatcher.reset();
+    } else {
+        m_folderWatcher->setWakeCallback([this]() { wake(); });
+    }
+    m_crawler = std::make_unique<DirectoryCrawler>();
+    m_crawler->setWakeCallback([this]() { wake(); });
+    
+    m_gpuTimer = std::make_unique<GpuTimer>();
+    
     return true;
 }
 
+void PicasaApp::setThumbnailCacheOptions(bool enabled, bool hashContents) 
+{
+    m_useThumbnailCache = enabled;
+    m_hashThumbnails = hashContents;
+}
+
+void PicasaApp::setShaderCacheEnabled(bool enabled) 
+{
+    m_useShaderCache = enabled;
+}
+
+void PicasaApp::setWorkerThreads(unsigned threadCount) 
+{
+    m_workerThreads = threadCount;
+}
+
+void PicasaApp::setGridMarginRows(int rows) 
+{
+    m_gridMarginRows = std::max(0, rows);
+}
+
+void PicasaApp::setTextureBudget(size_t byteBudget) 
+{
+    m_textureBudget = byteBudget;
+    
+    if (m_textureCache) {
+        m_textureCache->setBudget(byteBudget);
+    }
+}
+
+void PicasaApp::setUploadBudget(size_t bytesPerFrame) 
+{
+    m_uploadBytesPerFrame = bytesPerFrame;
+}
+
+void PicasaApp::setTextureCompression(TextureCompression compression) 
+{
+    m_textureCompression = compression;
+}
+
+void PicasaApp::setCrawlOptions(const CrawlOptions& options) 
+{
+    m_crawlOptions = options;
+}
+
+void PicasaApp::setShowStats(bool show) 
+{
+    m_showStats = show;
+    Profiler::setStatsEnabled(show);
+    
+    if (!show && m_window) {
+        glfwSetWindowTitle(m_window, m_title.c_str());
+        m_statsTitle.clear();
+    }
+}
+
+void PicasaApp::setPrefetchOptions(int imagesAhead, size_t byteBudget) 
+{
+    m_prefetchAhead = std::max(0, imagesAhead);
+    m_prefetchBudget = byteBudget;
+    
+    if (m_prefetcher) {
+        m_prefetcher->setRing(m_prefetchAhead, m_prefetchBudget);
+    }
+}
+
 void PicasaApp::run() 
 {
     while (!glfwWindowShouldClose(m_window)) 
     {
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        waitForEvents();
         
-        render();
+        beginFrame();
+        update();
         
-        glfwSwapBuffers(m_window);
+        if (m_needsRedraw) 
+        {
+            m_needsRedraw = false;
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            
+            render();
+            
+            // Mostly the wait for vsync
+            PROFILE_SCOPE("swap");
+            glfwSwapBuffers(m_window);
+        }
+        endFrame();
+    }
+}
+
+void PicasaApp::wake() 
+{
+    if (!m_wakePending.exchange(true)) {
+        glfwPostEmptyEvent();
+    }
+}
+
+void PicasaApp::waitForEvents() 
+{
+    double timeout = getWaitTimeout();
+    if (timeout > 0.0) {
+        glfwWaitEventsTimeout(timeout);
+    } else {
         glfwPollEvents();
     }
+    m_wakePending = false;
+}
+
+double PicasaApp::getWaitTimeout() const 
+{
+    // Workers wake the loop when they finish something; the timeouts only
+    // pace streamed uploads and pick up crawl batches held back for batching
+    const double kUploadInterval = 1.0 / 60.0;
+    const double kCrawlInterval = 0.25;
+    const double kIdleInterval = 2.0;
+    
+    if (m_needsRedraw) {
+        return 0.0;
+    }
+    if (m_pendingTexture || (m_uploadStream && m_uploadStream->getStats().pendingTextures > 0)) {
+        return kUploadInterval;
+    }
+    if (m_crawler && (!m_crawler->isDone() || m_rescanning)) {
+        return kCrawlInterval;
+    }
+    return kIdleInterval;
+}
+
+void PicasaApp::beginFrame() 
+{
+    Profiler::beginFrame();
+    if (m_gpuTimer) {
+        m_gpuTimer->collect();
+    }
+    
+    // The title only changes when a new stats window is published
+    if (m_showStats) {
+        char stats[128];
+        char title[384];
+        formatStatsText(stats, sizeof(stats), false);
+        std::snprintf(title, sizeof(title), "%s | %s", m_title.c_str(), stats);
+        if (m_statsTitle != title) {
+            glfwSetWindowTitle(m_window, title);
+            m_statsTitle.assign(title);
+        }
+    }
+}
+
+void PicasaApp::endFrame() 
+{
+    Profiler::endFrame();
+}
+
+void PicasaApp::formatStatsText(char* buffer, size_t size, bool detailed) const 
+{
+    const Profiler::FrameStats& stats = Profiler::getFrameStats();
+    int written = std::snprintf(buffer, size, "%.2f ms/frame, %.0f fps, worst %.1f ms",
+                                stats.frameMs, stats.fps, stats.worstFrameMs);
+    
+    if (detailed) {
+        for (const Profiler::ScopeStats& scope : stats.scopes) {
+            if (written < 0 || static_cast<size_t>(written) >= size) {
+                break;
+            }
+            written += std::snprintf(buffer + written, size - written, "\n%-24s cpu %6.2f ms  gpu %6.2f ms",
+                                     scope.name, scope.cpuMs, scope.gpuMs);
+        }
+        
+        // Totals since start; decode time leaves out the reads it waited on
+        IoStats io = IoStatistics::get();
+        if (written >= 0 && static_cast<size_t>(written) < size) {
+            written += std::snprintf(buffer + written, size - written,
+                                     "\nI/O %.1f MB (%llu files) in %.0f ms, %.1f MB read ahead, decode %.0f ms",
+                                     io.bytesRead / (1024.0 * 1024.0), static_cast<unsigned long long>(io.files),
+                                     io.ioMs, io.bytesReadAhead / (1024.0 * 1024.0), io.decodeMs);
+        }
+        
+        PixelPoolStats pool = PixelPool::getStats();
+        if (written >= 0 && static_cast<size_t>(written) < size) {
+            double reusedPercent = pool.allocations ? 100.0 * pool.reused / pool.allocations : 0.0;
+            std::snprintf(buffer + written, size - written,
+                          "\nPixels %.0f MB in use, %.0f MB idle, peak %.0f of %.0f MB, %.0f%% reused, %llu refused",
+                          pool.inUseBytes / (1024.0 * 1024.0), pool.idleBytes / (1024.0 * 1024.0),
+                          pool.peakBytes / (1024.0 * 1024.0), pool.ceilingBytes / (1024.0 * 1024.0),
+                          reusedPercent, static_cast<unsigned long long>(pool.failures));
+        }
+    }
 }
 
 void PicasaApp::loadFolder(const std::string& folderPath) 
 {
-    m_imageFiles = getImageFilesInFolder(folderPath);
+    m_folderPath = folderPath;
+    while (m_folderPath.size() > 1 && m_folderPath.back() == '/') {
+        m_folderPath.pop_back();
+    }
+    if (m_folderWatcher) {
+        m_folderWatcher->clear();
+        m_folderWatcher->watch(m_folderPath);
+    }
     
-    if (!m_imageFiles.empty()) 
-    {
-        m_currentIndex = 0;
-        loadImage(m_imageFiles[m_currentIndex]);
-        generateThumbnails();
+    // Starts empty; processFolderChanges() adds what the crawler finds and
+    // shows the first image as soon as there is one
+    m_imageFiles.clear();
+    m_fileIndex.clear();
+    m_currentIndex = 0;
+    clearCurrentImage();
+    
+    if (m_prefetcher) {
+        m_prefetcher->setFiles(m_imageFiles);
+    }
+    generateThumbnails();
+    
+    m_rescanning = false;
+    m_rescanSeen.clear();
+    m_lastCrawlApply = 0.0;
+    if (m_crawler) {
+        m_crawler->start(m_folderPath, m_crawlOptions, &PicasaApp::isImagePath);
     }
 }
 
 void PicasaApp::loadImage(const std::string& imagePath) 
 {
-    m_currentTexture = std::make_unique<Texture>();
-    if (!m_currentTexture->loadFromFile(imagePath)) {
-        std::cerr << "Failed to load image: " << imagePath << std::endl;
-        m_currentTexture.reset();
-        return;
+    PROFILE_SCOPE_DETAIL("loadImage", imagePath);
+    requestRedraw();
+    
+    auto it = m_fileIndex.find(imagePath);
+    int index = (it != m_fileIndex.end()) ? it->second : -1;
+    
+    m_loadStartTime = glfwGetTime();
+    m_loadTimings = LoadTimings();
+    m_pendingIndex = -1;
+    
+    if (m_pendingTexture) {
+        if (m_uploadStream) {
+            m_uploadStream->cancel(m_pendingTexture.get());
+        }
+        m_pendingTexture.reset();
+    }
+    
+    // Recently viewed: already resident on the GPU
+    std::shared_ptr<Texture> texture = m_textureCache ? m_textureCache->find(imagePath) : nullptr;
+    
+    int width = 0, height = 0, channels = 0;
+    bool known = false;
+    if (texture) {
+        width = texture->getWidth();
+        height = texture->getHeight();
+    } else if (index >= 0 && m_thumbnails[index].info.isValid()) {
+        // Probed while crawling, no need to open the file again
+        const ImageInfo& info = m_thumbnails[index].info;
+        width = info.width;
+        height = info.height;
+        channels = info.channels;
+        known = true;
+    } else {
+        known = ImageDecoder::readInfo(imagePath, width, height, channels);
+    }
+    
+    // Too large for one texture (or for memory): stream into a tile pyramid
+    std::unique_ptr<TiledImage> tiled;
+    if (known && (std::max(width, height) > m_maxTextureSize || 
+                  static_cast<size_t>(width) * height > m_maxTexturePixels)) 
+    {
+        tiled = std::make_unique<TiledImage>();
+        tiled->setWakeCallback([this]() { wake(); });
+        if (!tiled->open(imagePath, width, height, ThumbnailCache::defaultDirectory() + "/tiles")) {
+            std::cerr << "Failed to load image: " << imagePath << std::endl;
+            m_currentTexture.reset();
+            m_tiledImage.reset();
+            return;
+        }
+    }
+    
+    // A prefetched neighbour only needs the upload
+    std::shared_ptr<const DecodedImage> image;
+    bool prefetched = false;
+    if (!texture && !tiled && m_prefetcher && index >= 0) {
+        image = m_prefetcher->get(index);
+        prefetched = image != nullptr;
+    }
+    
+    // Orientation is applied through m_rotation, the pixels stay as stored
+    ImageMetadata metadata;
+    if (JpegDecoder::isJpegPath(imagePath) || ExifReader::isRawPath(imagePath)) {
+        ExifReader::read(imagePath, metadata);
+    }
+    
+    // Large images: show a preview now and let the prefetch workers do the
+    // full decode, picked up and streamed to the GPU by processPendingImage()
+    bool progressive = !texture && !tiled && known && index >= 0 && m_prefetcher &&
+                       static_cast<size_t>(width) * height > m_progressivePixels;
+    
+    if (progressive) 
+    {
+        // Prefetched: the worker already scaled a preview, so nothing is
+        // decoded here and the streaming starts with the next update
+        if (prefetched) {
+            std::shared_ptr<const DecodedImage> preview = m_prefetcher->getPreview(index);
+            texture = std::make_shared<Texture>();
+            if (!preview || !texture->loadFromMemory(preview->pixels.data(), preview->width,
+                                                     preview->height, preview->channels)) {
+                texture.reset();
+            }
+        } else {
+            texture = loadPreview(imagePath, metadata);
+        }
+        m_pendingIndex = index;
+    } 
+    else if (!texture && !tiled) 
+    {
+        if (!image) {
+            auto decoded = std::make_shared<DecodedImage>();
+            if (ImageDecoder::decodeFile(imagePath, *decoded)) {
+                image = std::move(decoded);
+            }
+        }
+        
+        texture = std::make_shared<Texture>();
+        if (!image || !texture->loadFromMemory(image->pixels.data(), image->width, image->height, image->channels)) {
+            std::cerr << "Failed to load image: " << imagePath << std::endl;
+            m_currentTexture.reset();
+            m_tiledImage.reset();
+            return;
+        }
+        width = image->width;
+        height = image->height;
+        
+        if (m_textureCache) {
+            m_textureCache->insert(imagePath, texture);
+        }
     }
     
+    m_currentTexture = std::move(texture);
+    m_tiledImage = std::move(tiled);
+    m_showingPreview = progressive;
+    m_imageWidth = width;
+    m_imageHeight = height;
+    m_current_image_path = imagePath;
     m_scale = 1.0f;
     m_offset = glm::vec2(0.0f, 0.0f);
-    m_rotation = 0.0f;
+    m_uprightRotation = ExifReader::orientationRotation(metadata.orientation);
+    m_rotation = m_uprightRotation;
+    
+    if (m_currentTexture) {
+        m_loadTimings.fromPreview = progressive;
+        recordLoadTime(m_loadTimings.firstPixelMs);
+        if (!progressive) {
+            recordLoadTime(m_loadTimings.fullResolutionMs);
+        }
+    }
+    
+    if (index >= 0) {
+        m_currentIndex = index;
+        
+        if (m_prefetcher) {
+            m_prefetcher->update(index, m_navigationDirection, prefetched ? nullptr : image);
+        }
+    }
+}
+
+std::shared_ptr<Texture> PicasaApp::loadPreview(const std::string& imagePath, const ImageMetadata& metadata) 
+{
+    auto preview = std::make_shared<Texture>();
+    
+    // The grid thumbnail is a page-cache read away (already block compressed
+    // when compression is on), but it is stored upright
+    ThumbnailCache::Entry entry;
+    bool upright = ExifReader::orientationQuarterTurns(metadata.orientation) == 0;
+    if (upright && m_thumbnailCache && m_thumbnailCache->lookup(imagePath, m_thumbnailSize, entry))
+    {
+        bool loaded = (entry.format != BlockFormat::None)
+            ? preview->loadCompressed(entry.pixels, entry.byteSize, entry.width, entry.height, entry.channels, entry.format)
+            : preview->loadFromMemory(entry.pixels, entry.width, entry.height, entry.channels);
+        if (loaded) {
+            return preview;
+        }
+    }
+    
+    // Then an embedded EXIF/RAW preview, or a 1/8 scale JPEG decode that
+    // skips most of the IDCT work
+    DecodedImage image;
+    const EmbeddedPreview* embedded = ExifReader::findPreview(metadata, m_thumbnailSize);
+    std::vector<unsigned char> data;
+    bool decoded = embedded && ExifReader::readPreview(imagePath, *embedded, data) &&
+                   JpegDecoder::decodeScaledMemory(data.data(), data.size(), m_thumbnailSize, image);
+    
+    if (!decoded && JpegDecoder::isJpegPath(imagePath)) {
+        decoded = JpegDecoder::decodeScaled(imagePath, m_thumbnailSize, image);
+    }
+    
+    if (decoded && preview->loadFromMemory(image.pixels.data(), image.width, image.height, image.channels)) {
+        return preview;
+    }
+    
+    return nullptr;
+}
+
+void PicasaApp::processPendingImage() 
+{
+    PROFILE_SCOPE("processPendingImage");
+    
+    // Woken as tile rows finish; each one may fill in part of the view
+    if (m_tiledImage) {
+        if (!m_tiledImage->isComplete()) {
+            requestRedraw();
+        }
+        if (m_tiledImage->hasPreview()) {
+            recordLoadTime(m_loadTimings.firstPixelMs);
+        }
+        if (m_tiledImage->isComplete()) {
+            recordLoadTime(m_loadTimings.fullResolutionMs);
+        }
+        return;
+    }
+    
+    // Streaming: swap in once the last band has been issued
+    if (m_pendingTexture) {
+        if (m_uploadStream && m_uploadStream->isPending(m_pendingTexture.get())) {
+            return;
+        }
+        showFullResolution(std::move(m_pendingTexture));
+        return;
+    }
+    
+    if (m_pendingIndex < 0 || m_pendingIndex >= static_cast<int>(m_imageFiles.size())) {
+        return;
+    }
+    
+    // The decode always runs on a prefetch worker, never here
+    std::shared_ptr<const DecodedImage> image = m_prefetcher ? m_prefetcher->get(m_pendingIndex) : nullptr;
+    if (!image) {
+        if (!m_prefetcher || m_prefetcher->hasFailed(m_pendingIndex)) {
+            // The preview stays up, but nothing is loading any more
+            std::cerr << "Failed to load image: " << m_imageFiles[m_pendingIndex] << std::endl;
+            m_pendingIndex = -1;
+            m_showingPreview = false;
+            requestRedraw();
+        } else if (!m_prefetcher->isLoading(m_pendingIndex)) {
+            // Dropped from the ring, e.g. by a folder change: queue it again
+            m_prefetcher->update(m_pendingIndex, m_navigationDirection);
+        }
+        return;
+    }
+    
+    const std::string& imagePath = m_imageFiles[m_pendingIndex];
+    m_pendingIndex = -1;
+    
+    // Spread over as many frames as the upload budget needs
+    auto texture = std::make_shared<Texture>();
+    if (m_uploadStream && texture->allocate(image->width, image->height, image->channels)) {
+        m_uploadStream->uploadTexture(texture, std::move(image));
+        m_pendingTexture = std::move(texture);
+        return;
+    }
     
-    auto it = std::find(m_imageFiles.begin(), m_imageFiles.end(), imagePath);
-    if (it != m_imageFiles.end()) {
-        m_currentIndex = std::distance(m_imageFiles.begin(), it);
+    if (!texture->loadFromMemory(image->pixels.data(), image->width, image->height, image->channels)) {
+        std::cerr << "Failed to load image: " << imagePath << std::endl;
+        m_showingPreview = false;
+        requestRedraw();
+        return;
+    }
+    
+    showFullResolution(std::move(texture));
+}
+
+void PicasaApp::showFullResolution(std::shared_ptr<Texture> texture) 
+{
+    if (m_textureCache) {
+        m_textureCache->insert(m_current_image_path, texture);
+    }
+    
+    // Same image dimensions, so zoom, pan and rotation carry over unchanged
+    m_currentTexture = std::move(texture);
+    m_showingPreview = false;
+    requestRedraw();
+    recordLoadTime(m_loadTimings.firstPixelMs);
+    recordLoadTime(m_loadTimings.fullResolutionMs);
+}
+
+void PicasaApp::recordLoadTime(double& milliseconds) 
+{
+    // The info label shows it
+    if (milliseconds < 0.0) {
+        milliseconds = (glfwGetTime() - m_loadStartTime) * 1000.0;
+        requestRedraw();
     }
 }
 
 void PicasaApp::setupShaders() 
 {
-    m_shader = std::make_unique<Shader>();
-    if (!m_shader->loadFromFiles("shaders/image.vert", "shaders/image.frag")) {
+    m_frameUniforms = std::make_unique<UniformBuffer>();
+    m_frameUniforms->create(kFrameUniforms, sizeof(FrameUniforms));
+    
+    m_shaderManager = std::make_unique<ShaderManager>("shaders");
+    if (m_useShaderCache) {
+        m_shaderManager->setCacheDirectory(ThumbnailCache::defaultDirectory() + "/shaders");
+    }
+    
+    m_imageProgram = setupImageProgram(0);
+    m_grayscaleProgram = setupImageProgram(kShaderGrayscale);
+    if (!m_imageProgram.shader) {
         std::cerr << "Failed to load shaders" << std::endl;
     }
+    
+    m_thumbnailShader = m_shaderManager->get("thumbnail");
+    if (!m_thumbnailShader) {
+        std::cerr << "Failed to load thumbnail shaders" << std::endl;
+    } else {
+        m_thumbnailShader->bindUniformBlock("Frame", kFrameUniforms);
+        m_thumbnailShader->use();
+        m_thumbnailShader->set(m_thumbnailShader->getUniform<int>("thumbnailTexture"), 0);
+    }
+}
+
+PicasaApp::ImageProgram PicasaApp::setupImageProgram(unsigned features) 
+{
+    ImageProgram program;
+    program.shader = m_shaderManager->get("image", features);
+    if (program.shader) {
+        program.shader->bindUniformBlock("Frame", kFrameUniforms);
+        program.model = program.shader->getUniform<glm::mat4>("model");
+        program.shader->use();
+        program.shader->set(program.shader->getUniform<int>("imageTexture"), 0);
+    }
+    return program;
 }
 
 void PicasaApp::setupGeometry() 
@@ -184,12 +786,78 @@ void PicasaApp::setupGeometry()
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
     
+    // Thumbnail grid: same quad, plus one ThumbnailInstance per thumbnail
+    glGenVertexArrays(1, &m_thumbnailVao);
+    glBindVertexArray(m_thumbnailVao);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    
+    glGenBuffers(1, &m_instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+    
+    for (GLuint attribute = 2; attribute <= 4; attribute++) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    setThumbnailInstanceOffset(0);
+    
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
 
+void PicasaApp::setThumbnailInstanceOffset(size_t firstInstance) 
+{
+    size_t base = firstInstance * sizeof(ThumbnailInstance);
+    
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ThumbnailInstance),
+                          (void*)(base + offsetof(ThumbnailInstance, rect)));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(ThumbnailInstance),
+                          (void*)(base + offsetof(ThumbnailInstance, uvRect)));
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(ThumbnailInstance),
+                          (void*)(base + offsetof(ThumbnailInstance, layer)));
+}
+
+void PicasaApp::update() 
+{
+    PROFILE_SCOPE("update");
+    GpuScope gpu(m_gpuTimer.get(), "update");
+    
+    if (m_uploadStream) {
+        m_uploadStream->beginFrame();
+    }
+    
+    processFolderChanges();
+    m_gridLayout.update(m_width, m_height, m_thumbnailSize + 10, static_cast<int>(m_thumbnails.size()));
+    
+    processPendingImage();
+    updateThumbnailWindow();
+    processThumbnailUploads();
+    
+    // Issues this frame's copies before anything is drawn
+    if (m_uploadStream) {
+        PROFILE_SCOPE("uploadStream");
+        m_uploadStream->endFrame();
+    }
+}
+
 void PicasaApp::render() 
 {
+    PROFILE_SCOPE("render");
+
+    if (m_frameUniforms) {
+        FrameUniforms frame;
+        frame.projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+        frame.view = glm::mat4(1.0f);
+        m_frameUniforms->update(frame);
+    }
+    
     if (m_showThumbnails) 
     {
         renderThumbnails();
@@ -204,99 +872,202 @@ void PicasaApp::render()
 
 void PicasaApp::renderImage() 
 {
-    if (!m_currentTexture || !m_shader) {
+    PROFILE_SCOPE("renderImage");
+    GpuScope gpu(m_gpuTimer.get(), "renderImage");
+    
+    // Single channel textures sample as red; their program shows them grey
+    bool grayscale = !m_tiledImage && m_currentTexture && m_currentTexture->getChannels() == 1;
+    const ImageProgram& program = (grayscale && m_grayscaleProgram.shader) ? m_grayscaleProgram : m_imageProgram;
+    if ((!m_currentTexture && !m_tiledImage) || !program.shader) {
         return;
     }
     
-    m_shader->use();
+    int imageWidth, imageHeight;
+    getCurrentImageSize(imageWidth, imageHeight);
     
-    float imageAspect = static_cast<float>(m_currentTexture->getWidth()) / m_currentTexture->getHeight();
+    program.shader->use();
+    
+    glm::mat4 model = getImageModelMatrix(imageWidth, imageHeight);
+    
+    if (m_tiledImage) {
+        if (!m_tiledImage->render(*program.shader, program.model, m_vao, model, m_width, m_height)) {
+            requestRedraw();
+        }
+        return;
+    }
+    
+    program.shader->set(program.model, model);
+    m_currentTexture->bind(0);
+    
+    glBindVertexArray(m_vao);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
+
+glm::mat4 PicasaApp::getImageModelMatrix(int imageWidth, int imageHeight) const
+{
+    // An odd number of quarter turns stands the image on its side
+    int quarterTurns = static_cast<int>(std::lround(m_rotation / 90.0f));
+    bool sideways = quarterTurns % 2 != 0;
+    
+    float imageAspect = static_cast<float>(imageWidth) / imageHeight;
+    float uprightAspect = sideways ? 1.0f / imageAspect : imageAspect;
     float windowAspect = static_cast<float>(m_width) / m_height;
     
-    float scaleX, scaleY;
-    if (imageAspect > windowAspect) 
+    // Fitted size of the upright image, in units of the window height
+    float fittedWidth, fittedHeight;
+    if (uprightAspect > windowAspect) 
     {
-        scaleX = 1.0f;
-        scaleY = windowAspect / imageAspect;
+        fittedWidth = windowAspect;
+        fittedHeight = windowAspect / uprightAspect;
     } 
     else 
     {
-        scaleX = imageAspect / windowAspect;
-        scaleY = 1.0f;
+        fittedWidth = uprightAspect;
+        fittedHeight = 1.0f;
     }
+    float scaleX = sideways ? fittedHeight : fittedWidth;
+    float scaleY = sideways ? fittedWidth : fittedHeight;
     
+    // Rotates where x and y share a unit, then squeezes x back into NDC
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(m_offset.x, m_offset.y, 0.0f));
+    model = glm::scale(model, glm::vec3(1.0f / windowAspect, 1.0f, 1.0f));
     model = glm::rotate(model, glm::radians(m_rotation), glm::vec3(0.0f, 0.0f, 1.0f));
     model = glm::scale(model, glm::vec3(scaleX * m_scale, scaleY * m_scale, 1.0f));
     
-    glm::mat4 projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
-    
-    m_shader->setMat4("model", glm::value_ptr(model));
-    m_shader->setMat4("projection", glm::value_ptr(projection));
-    
-    m_currentTexture->bind(0);
-    m_shader->setInt("imageTexture", 0);
+    return model;
+}
+
+bool PicasaApp::getCurrentImageSize(int& width, int& height) const
+{
+    if (m_tiledImage) {
+        width = m_tiledImage->getWidth();
+        height = m_tiledImage->getHeight();
+        return true;
+    }
+    if (m_currentTexture || m_pendingTexture || m_pendingIndex >= 0) {
+        // A preview texture is smaller than the image it stands in for
+        width = m_imageWidth;
+        height = m_imageHeight;
+        return true;
+    }
     
-    glBindVertexArray(m_vao);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    width = 0;
+    height = 0;
+    return false;
 }
 
 void PicasaApp::renderThumbnails() 
 {
-    if (m_thumbnails.empty() || !m_shader) {
+    PROFILE_SCOPE("renderThumbnails");
+    GpuScope gpu(m_gpuTimer.get(), "renderThumbnails");
+    
+    if (m_thumbnails.empty() || !m_thumbnailShader || !m_thumbnailAtlas) {
         return;
     }
     
-    m_shader->use();
-    
-    int cols = m_width / (m_thumbnailSize + 10);
-    if (cols < 1) cols = 1;
+    int first, last;
+    m_gridLayout.getVisibleRange(0, first, last);
     
-    int rows = (m_thumbnails.size() + cols - 1) / cols;
-    float cellWidth = 2.0f / cols;
-    float cellHeight = 2.0f / rows;
+    // Counting sort by atlas page so each page is one contiguous instance range;
+    // placeholders for probed images still loading go last, as one more range
+    int pageCount = m_thumbnailAtlas->getPageCount();
+    m_pageInstanceCounts.assign(pageCount + 2, 0);
+    for (int i = first; i < last; i++) {
+        const ThumbnailCell& cell = m_thumbnails[i];
+        if (cell.state == ThumbnailState::Resident) {
+            m_pageInstanceCounts[cell.slot.page + 1]++;
+        } else if (cell.state != ThumbnailState::Failed && cell.info.isValid()) {
+            m_pageInstanceCounts[pageCount + 1]++;
+        }
+    }
+    for (int page = 0; page <= pageCount; page++) {
+        m_pageInstanceCounts[page + 1] += m_pageInstanceCounts[page];
+    }
     
-    glm::mat4 projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
-    m_shader->setMat4("projection", glm::value_ptr(projection));
+    size_t instanceCount = m_pageInstanceCounts[pageCount + 1];
+    if (instanceCount == 0) {
+        return;
+    }
+    m_thumbnailInstances.resize(instanceCount);
     
-    for (size_t i = 0; i < m_thumbnails.size(); i++) 
+    std::vector<int>& cursor = m_pageInstanceCounts;
+    for (int i = first; i < last; i++) 
     {
-        int row = i / cols;
-        int col = i % cols;
+        const ThumbnailCell& cell = m_thumbnails[i];
+        bool resident = cell.state == ThumbnailState::Resident;
+        if (!resident && (cell.state == ThumbnailState::Failed || !cell.info.isValid())) {
+            continue;
+        }
         
-        float x = -1.0f + col * cellWidth + cellWidth * 0.5f;
-        float y = 1.0f - row * cellHeight - cellHeight * 0.5f;
+        float cellX, cellY, cellWidth, cellHeight;
+        m_gridLayout.getCellRect(i, cellX, cellY, cellWidth, cellHeight);
         
-        float thumbAspect = static_cast<float>(m_thumbnails[i]->getWidth()) / m_thumbnails[i]->getHeight();
-        float scaleX = cellWidth * 0.9f;
-        float scaleY = scaleX / thumbAspect;
+        // Fit in pixels so the aspect ratio survives a non-square window
+        float thumbAspect = resident ? static_cast<float>(cell.slot.width) / cell.slot.height
+                                     : cell.info.getUprightAspect();
+        float width = cellWidth * 0.9f;
+        float height = width / thumbAspect;
         
-        if (scaleY > cellHeight * 0.9f) 
+        if (height > cellHeight * 0.9f) 
         {
-            scaleY = cellHeight * 0.9f;
-            scaleX = scaleY * thumbAspect;
+            height = cellHeight * 0.9f;
+            width = height * thumbAspect;
         }
         
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(x, y, 0.0f));
-        model = glm::scale(model, glm::vec3(scaleX, scaleY, 1.0f));
-        
-        if (i == static_cast<size_t>(m_currentIndex)) {
-            model = glm::scale(model, glm::vec3(1.1f, 1.1f, 1.0f));
+        if (i == m_currentIndex) {
+            width *= 1.1f;
+            height *= 1.1f;
         }
         
-        m_shader->setMat4("model", glm::value_ptr(model));
-        
-        m_thumbnails[i]->bind(0);
-        m_shader->setInt("imageTexture", 0);
-        
-        glBindVertexArray(m_vao);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        ThumbnailInstance& instance = m_thumbnailInstances[cursor[resident ? cell.slot.page : pageCount]++];
+        instance.rect[0] = (cellX + cellWidth * 0.5f) / m_width * 2.0f - 1.0f;
+        instance.rect[1] = 1.0f - (cellY + cellHeight * 0.5f) / m_height * 2.0f;
+        instance.rect[2] = width / m_width * 2.0f;
+        instance.rect[3] = height / m_height * 2.0f;
+        if (resident) {
+            m_thumbnailAtlas->getUvRect(cell.slot, instance.uvRect);
+            instance.layer = static_cast<float>(cell.slot.layer);
+        } else {
+            // A negative layer draws flat grey
+            std::fill(instance.uvRect, instance.uvRect + 4, 0.0f);
+            instance.layer = -1.0f;
+        }
+    }
+    
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+    size_t bytes = instanceCount * sizeof(ThumbnailInstance);
+    if (bytes > m_instanceCapacity) {
+        m_instanceCapacity = bytes * 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, m_thumbnailInstances.data());
+    
+    m_thumbnailShader->use();
+    
+    glBindVertexArray(m_thumbnailVao);
+    glActiveTexture(GL_TEXTURE0);
+    
+    // After the fill loop cursor[page] is the end of that page's range;
+    // the placeholder range never samples, whatever page is bound
+    size_t begin = 0;
+    for (int page = 0; page <= pageCount; page++) 
+    {
+        size_t end = cursor[page];
+        if (end > begin) 
+        {
+            if (page < pageCount) {
+                glBindTexture(GL_TEXTURE_2D_ARRAY, m_thumbnailAtlas->getPageTexture(page));
+            }
+            setThumbnailInstanceOffset(begin);
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, static_cast<GLsizei>(end - begin));
+        }
+        begin = end;
     }
     
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void PicasaApp::renderUI() {
@@ -304,7 +1075,13 @@ void PicasaApp::renderUI() {
 }
 
 void PicasaApp::updateViewTransform() {
-    m_scale = std::max(0.1f, std::min(m_scale, 10.0f));
+    // Tiled images are worth zooming in until one pixel fills ~10 screen pixels
+    float maxScale = 10.0f;
+    if (m_tiledImage) {
+        float fitted = static_cast<float>(std::max(m_width, m_height));
+        maxScale = std::max(maxScale, 10.0f * std::max(m_tiledImage->getWidth(), m_tiledImage->getHeight()) / fitted);
+    }
+    m_scale = std::max(0.1f, std::min(m_scale, maxScale));
 }
 
 void PicasaApp::nextImage() {
@@ -312,8 +1089,10 @@ void PicasaApp::nextImage() {
         return;
     }
     
+    m_navigationDirection = 1;
     m_currentIndex = (m_currentIndex + 1) % m_imageFiles.size();
     loadImage(m_imageFiles[m_currentIndex]);
+    m_gridLayout.scrollToItem(m_currentIndex);
 }
 
 void PicasaApp::previousImage() {
@@ -321,44 +1100,548 @@ void PicasaApp::previousImage() {
         return;
     }
     
+    m_navigationDirection = -1;
     m_currentIndex = (m_currentIndex - 1 + m_imageFiles.size()) % m_imageFiles.size();
     loadImage(m_imageFiles[m_currentIndex]);
+    m_gridLayout.scrollToItem(m_currentIndex);
 }
 
 void PicasaApp::generateThumbnails() {
+    if (m_thumbnailLoader) {
+        m_thumbnailLoader->setFiles(m_imageFiles, m_thumbnailSize, m_thumbnailCache.get(), m_textureCompression);
+    }
+    
     m_thumbnails.clear();
+    m_thumbnails.resize(m_imageFiles.size());
+    
+    if (m_thumbnailAtlas) {
+        m_thumbnailAtlas->clear();
+    }
+    
+    m_windowFirst = 0;
+    m_windowLast = 0;
+    m_gridLayout.setScroll(0.0f);
+}
+
+void PicasaApp::updateThumbnailWindow() {
+    if (!m_thumbnailLoader || !m_showThumbnails) {
+        return;
+    }
+    
+    int first, last;
+    m_gridLayout.getVisibleRange(m_gridMarginRows, first, last);
+    if (first == m_windowFirst && last == m_windowLast && !m_thumbnailWindowDirty) {
+        return;
+    }
+    m_thumbnailWindowDirty = false;
+    
+    for (int i = m_windowFirst; i < m_windowLast; i++) {
+        if (i < first || i >= last) {
+            evictThumbnail(i);
+        }
+    }
+    
+    m_thumbnailLoader->setWindow(first, last);
+    
+    // On-screen rows first, then the margin below and above
+    int visibleFirst, visibleLast;
+    m_gridLayout.getVisibleRange(0, visibleFirst, visibleLast);
+    requestThumbnailsByCost(visibleFirst, visibleLast);
+    for (int i = visibleLast; i < last; i++) {
+        requestThumbnail(i);
+    }
+    for (int i = visibleFirst - 1; i >= first; i--) {
+        requestThumbnail(i);
+    }
+    
+    m_windowFirst = first;
+    m_windowLast = last;
+}
+
+void PicasaApp::requestThumbnail(int index) {
+    ThumbnailCell& cell = m_thumbnails[index];
+    if (cell.state == ThumbnailState::Empty) {
+        cell.state = ThumbnailState::Requested;
+        m_thumbnailLoader->request(index);
+    }
+}
+
+void PicasaApp::requestThumbnailsByCost(int first, int last) {
+    // Cheap decodes first, so most of the screen fills in while the big ones run
+    m_requestOrder.clear();
+    for (int i = first; i < last; i++) {
+        if (m_thumbnails[i].state == ThumbnailState::Empty) {
+            m_requestOrder.push_back(i);
+        }
+    }
+    std::stable_sort(m_requestOrder.begin(), m_requestOrder.end(), [this](int a, int b) {
+        return m_thumbnails[a].info.getDecodeCost() < m_thumbnails[b].info.getDecodeCost();
+    });
+    for (int index : m_requestOrder) {
+        requestThumbnail(index);
+    }
+}
+
+void PicasaApp::evictThumbnail(int index) {
+    ThumbnailCell& cell = m_thumbnails[index];
+    if (cell.state == ThumbnailState::Resident) {
+        m_thumbnailAtlas->release(cell.slot);
+        cell.state = ThumbnailState::Empty;
+    }
+}
+
+void PicasaApp::processThumbnailUploads() {
+    PROFILE_SCOPE("processThumbnailUploads");
+    
+    if (!m_thumbnailLoader || !m_thumbnailAtlas) {
+        return;
+    }
     
-    for (const auto& imagePath : m_imageFiles) {
-        auto texture = std::make_unique<Texture>();
-        if (texture->loadFromFile(imagePath)) {
-            auto thumbnail = texture->createThumbnail(m_thumbnailSize);
-            if (thumbnail) {
-                m_thumbnails.push_back(std::move(thumbnail));
+    // Bounded so a folder filling in never stalls a frame
+    ThumbnailResult result;
+    int uploads = 0;
+    bool failed = false;
+    while (uploads < m_maxThumbnailUploadsPerFrame && m_thumbnailLoader->poll(result)) 
+    {
+        if (result.index < 0 || result.index >= static_cast<int>(m_thumbnails.size())) {
+            continue;
+        }
+        
+        ThumbnailCell& cell = m_thumbnails[result.index];
+        bool inWindow = result.index >= m_windowFirst && result.index < m_windowLast;
+        
+        if (result.status == ThumbnailResult::Status::Failed) {
+            cell.state = ThumbnailState::Failed;
+            failed = true;
+            continue;
+        }
+        
+        if (result.status == ThumbnailResult::Status::Skipped || !inWindow) {
+            cell.state = ThumbnailState::Empty;
+            if (inWindow) {
+                requestThumbnail(result.index);
             }
+            continue;
+        }
+        
+        bool uploaded = result.isCompressed()
+            ? m_thumbnailAtlas->uploadCompressed(result.pixels(), result.byteSize(), result.width(), result.height(),
+                                                 result.format(), cell.slot)
+            : m_thumbnailAtlas->upload(result.pixels(), result.width(), result.height(), result.channels(), cell.slot);
+        if (uploaded) {
+            cell.state = ThumbnailState::Resident;
+        } else {
+            cell.state = ThumbnailState::Failed;
         }
+        uploads++;
+    }
+    
+    if (uploads > 0 || failed) {
+        requestRedraw();
     }
 }
 
-std::vector<std::string> PicasaApp::getImageFilesInFolder(const std::string& folderPath) 
+void PicasaApp::processFolderChanges() 
 {
-    std::vector<std::string> imageFiles;
+    PROFILE_SCOPE("processFolderChanges");
+    
+    if (m_folderPath.empty()) {
+        return;
+    }
+    
+    m_folderChanges.clear();
+    if (m_folderWatcher && !m_folderWatcher->poll(m_folderChanges)) {
+        std::cerr << "Folder events were dropped, rescanning " << m_folderPath << std::endl;
+        rescanFolder();
+    }
+    
+    size_t listed = m_imageFiles.size();
+    bool appended = appendCrawlResults();
+    
+    // Plain appends keep every index, queued thumbnail and decode valid
+    if (m_folderChanges.empty()) {
+        if (appended) {
+            std::vector<std::string> added(m_imageFiles.begin() + listed, m_imageFiles.end());
+            if (m_thumbnailLoader) {
+                m_thumbnailLoader->appendFiles(added);
+            }
+            if (m_prefetcher) {
+                m_prefetcher->appendFiles(added);
+            }
+            m_thumbnailWindowDirty = true;
+            requestRedraw();
+            
+            if (m_current_image_path.empty()) {
+                m_currentIndex = 0;
+                loadImage(m_imageFiles[0]);
+            }
+        }
+        return;
+    }
+    
+    int count = static_cast<int>(m_imageFiles.size());
+    std::vector<bool> removed(count, false);
+    std::vector<bool> modified(count, false);
+    bool currentChanged = false;
+    
+    auto isListed = [this](const std::string& path) {
+        size_t slash = path.find_last_of('/');
+        const char* name = path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+        return !m_crawler || !m_crawler->isIgnored(name);
+    };
     
-    try {
-        for (const auto& entry : fs::directory_iterator(folderPath)) {
-            if (entry.is_regular_file()) {
-                std::string ext = entry.path().extension().string();
-                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                
-                if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".gif") {
-                    imageFiles.push_back(entry.path().string());
+    auto removeFile = [&](const std::string& path) {
+        auto it = m_fileIndex.find(path);
+        if (it == m_fileIndex.end()) {
+            return;
+        }
+        int index = it->second;
+        m_fileIndex.erase(it);
+        removed[index] = true;
+        evictThumbnail(index);
+        if (m_textureCache) {
+            m_textureCache->erase(path);
+        }
+    };
+    
+    auto addOrUpdateFile = [&](const std::string& path) {
+        if (m_rescanning) {
+            m_rescanSeen.insert(path);
+        }
+        
+        // New files join the list once their header checks out
+        if (m_crawler) {
+            m_crawler->addFile(path);
+        }
+        
+        auto it = m_fileIndex.find(path);
+        if (it == m_fileIndex.end()) {
+            return;
+        }
+        
+        // Rewritten in place: only this thumbnail and decode are redone,
+        // the cache notices the new mtime by itself
+        int index = it->second;
+        evictThumbnail(index);
+        m_thumbnails[index].state = ThumbnailState::Empty;
+        m_thumbnails[index].info = ImageInfo();
+        if (index < count) {
+            modified[index] = true;
+        }
+        if (m_textureCache) {
+            m_textureCache->erase(path);
+        }
+        currentChanged = currentChanged || index == m_currentIndex;
+    };
+    
+    // The cell keeps its thumbnail, only the name changes
+    auto renameFile = [&](const std::string& oldPath, const std::string& newPath) {
+        auto it = m_fileIndex.find(oldPath);
+        int index = it->second;
+        m_fileIndex.erase(it);
+        removeFile(newPath);
+        m_fileIndex[newPath] = index;
+        m_imageFiles[index] = newPath;
+        if (m_rescanning) {
+            m_rescanSeen.insert(newPath);
+        }
+        if (m_textureCache) {
+            m_textureCache->erase(oldPath);
+        }
+        if (index == m_currentIndex) {
+            m_current_image_path = newPath;
+        }
+    };
+    
+    auto filesWithin = [this](const std::string& directory) {
+        std::vector<std::string> files;
+        std::string prefix = directory + "/";
+        for (const std::string& path : m_imageFiles) {
+            if (path.compare(0, prefix.size(), prefix) == 0 && m_fileIndex.count(path)) {
+                files.push_back(path);
+            }
+        }
+        return files;
+    };
+    
+    auto addDirectory = [&](const std::string& directory) {
+        int depth = getFolderDepth(directory);
+        int maxDepth = m_crawlOptions.maxDepth;
+        if (!isListed(directory) || (maxDepth >= 0 && depth > maxDepth)) {
+            return;
+        }
+        if (m_folderWatcher) {
+            m_folderWatcher->watch(directory);
+        }
+        if (m_crawler) {
+            m_crawler->add(directory, depth);
+        }
+    };
+    
+    auto removeDirectory = [&](const std::string& directory) {
+        if (m_folderWatcher) {
+            m_folderWatcher->unwatch(directory);
+        }
+        std::vector<std::string> files = (directory == m_folderPath) ? m_imageFiles : filesWithin(directory);
+        for (const std::string& path : files) {
+            removeFile(path);
+        }
+    };
+    
+    for (const FolderChange& change : m_folderChanges)
+    {
+        if (change.directory) {
+            switch (change.type) {
+                case FolderChange::Type::Changed:
+                    addDirectory(change.path);
+                    break;
+                case FolderChange::Type::Removed:
+                    removeDirectory(change.path);
+                    break;
+                case FolderChange::Type::Renamed: {
+                    // The watcher has already moved its watches to the new name
+                    bool watched = m_folderWatcher && m_folderWatcher->isWatched(change.path);
+                    if (!watched) {
+                        addDirectory(change.path);
+                    } else if (!isListed(change.path)) {
+                        removeDirectory(change.path);
+                        removeDirectory(change.oldPath);
+                    } else {
+                        std::string prefix = change.oldPath + "/";
+                        for (const std::string& path : filesWithin(change.oldPath)) {
+                            renameFile(path, change.path + "/" + path.substr(prefix.size()));
+                        }
+                    }
+                    break;
+                }
+            }
+            continue;
+        }
+        
+        bool wanted = isImagePath(change.path) && isListed(change.path);
+        switch (change.type) {
+            case FolderChange::Type::Changed:
+                if (wanted) {
+                    addOrUpdateFile(change.path);
+                }
+                break;
+            case FolderChange::Type::Removed:
+                removeFile(change.path);
+                break;
+            case FolderChange::Type::Renamed:
+                if (m_fileIndex.count(change.oldPath) && wanted) {
+                    renameFile(change.oldPath, change.path);
+                } else {
+                    removeFile(change.oldPath);
+                    if (wanted) {
+                        addOrUpdateFile(change.path);
+                    }
                 }
+                break;
+        }
+    }
+    
+    std::vector<int> remap(m_imageFiles.size());
+    for (size_t i = 0; i < remap.size(); i++) {
+        remap[i] = static_cast<int>(i);
+    }
+    bool currentRemoved = m_currentIndex < count && removed[m_currentIndex];
+    if (std::find(removed.begin(), removed.end(), true) != removed.end()) {
+        removeImageFiles(removed, remap);
+    }
+    
+    // Worker queues hold indices, so they restart on the new list; finished
+    // thumbnails and decoded images move along with their files
+    if (m_thumbnailLoader) {
+        m_thumbnailLoader->setFiles(m_imageFiles, m_thumbnailSize, m_thumbnailCache.get(), m_textureCompression);
+    }
+    for (ThumbnailCell& cell : m_thumbnails) {
+        if (cell.state == ThumbnailState::Requested) {
+            cell.state = ThumbnailState::Empty;
+        }
+    }
+    m_thumbnailWindowDirty = true;
+    requestRedraw();
+    
+    if (m_prefetcher) {
+        std::vector<int> prefetchRemap = remap;
+        for (int i = 0; i < count; i++) {
+            if (modified[i]) {
+                prefetchRemap[i] = -1;
             }
         }
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "Error reading directory: " << e.what() << std::endl;
+        m_prefetcher->remapFiles(m_imageFiles, prefetchRemap);
+    }
+    
+    if (m_pendingIndex >= 0) {
+        m_pendingIndex = (m_pendingIndex < count) ? remap[m_pendingIndex] : -1;
+    }
+    
+    if (m_imageFiles.empty()) {
+        m_currentIndex = 0;
+        clearCurrentImage();
+        return;
     }
     
-    return imageFiles;
+    if (currentRemoved || m_current_image_path.empty()) {
+        // Show whatever slid into its place
+        int next = m_currentIndex;
+        int last = static_cast<int>(remap.size());
+        while (next < last && remap[next] < 0) {
+            next++;
+        }
+        m_currentIndex = (next < last) ? remap[next] : static_cast<int>(m_imageFiles.size()) - 1;
+        loadImage(m_imageFiles[m_currentIndex]);
+    } else if (m_currentIndex < count) {
+        m_currentIndex = remap[m_currentIndex];
+        if (currentChanged) {
+            loadImage(m_imageFiles[m_currentIndex]);
+        }
+    }
+}
+
+bool PicasaApp::appendCrawlResults() 
+{
+    if (!m_crawler) {
+        return false;
+    }
+    
+    // Publishing the grown list copies it, so appends are batched; the first
+    // files of a folder go out right away
+    const double kCrawlApplyInterval = 0.25;
+    double now = glfwGetTime();
+    bool done = m_crawler->isDone();
+    if (!done && !m_imageFiles.empty() && now - m_lastCrawlApply < kCrawlApplyInterval) {
+        return false;
+    }
+    m_lastCrawlApply = now;
+    
+    m_crawlFiles.clear();
+    m_crawlDirectories.clear();
+    m_crawler->poll(m_crawlFiles, m_crawlDirectories);
+    
+    // Files created before the watch is in place are still found by the listing
+    if (m_folderWatcher) {
+        for (const std::string& directory : m_crawlDirectories) {
+            m_folderWatcher->watch(directory);
+        }
+    }
+    
+    bool appended = false;
+    for (CrawledFile& file : m_crawlFiles)
+    {
+        if (m_rescanning) {
+            m_rescanSeen.insert(file.path);
+        }
+        
+        // Known files come back after a change on disk, with a fresh probe
+        auto it = m_fileIndex.find(file.path);
+        if (it != m_fileIndex.end()) {
+            m_thumbnails[it->second].info = file.info;
+            continue;
+        }
+        
+        int index = static_cast<int>(m_imageFiles.size());
+        m_fileIndex.emplace(file.path, index);
+        // Opened by path before the listing got to it
+        if (file.path == m_current_image_path) {
+            m_currentIndex = index;
+        }
+        m_imageFiles.push_back(std::move(file.path));
+        m_thumbnails.emplace_back();
+        m_thumbnails.back().info = file.info;
+        appended = true;
+    }
+    
+    // After a rescan whatever the new listing did not see is gone
+    if (m_rescanning && done) {
+        m_rescanning = false;
+        for (const std::string& path : m_imageFiles) {
+            if (!m_rescanSeen.count(path)) {
+                FolderChange change;
+                change.type = FolderChange::Type::Removed;
+                change.path = path;
+                m_folderChanges.push_back(change);
+            }
+        }
+        m_rescanSeen.clear();
+    }
+    
+    return appended;
+}
+
+void PicasaApp::rescanFolder() 
+{
+    // Additions stream in as usual; removals are settled once the listing is complete
+    m_rescanning = true;
+    m_rescanSeen.clear();
+    if (m_crawler) {
+        m_crawler->start(m_folderPath, m_crawlOptions, &PicasaApp::isImagePath);
+    }
+}
+
+int PicasaApp::getFolderDepth(const std::string& directory) const 
+{
+    if (directory.size() <= m_folderPath.size()) {
+        return 0;
+    }
+    return static_cast<int>(std::count(directory.begin() + m_folderPath.size(), directory.end(), '/'));
+}
+
+void PicasaApp::removeImageFiles(const std::vector<bool>& removed, std::vector<int>& remap) 
+{
+    // One compaction for the whole batch; only shifted files are re-indexed
+    size_t kept = 0;
+    for (size_t i = 0; i < m_imageFiles.size(); i++)
+    {
+        bool gone = i < removed.size() && removed[i];
+        if (i < remap.size()) {
+            remap[i] = gone ? -1 : static_cast<int>(kept);
+        }
+        if (gone) {
+            continue;
+        }
+        if (kept != i) {
+            m_imageFiles[kept] = std::move(m_imageFiles[i]);
+            m_thumbnails[kept] = m_thumbnails[i];
+            m_fileIndex[m_imageFiles[kept]] = static_cast<int>(kept);
+        }
+        kept++;
+    }
+    
+    m_imageFiles.resize(kept);
+    m_thumbnails.resize(kept);
+}
+
+void PicasaApp::clearCurrentImage() 
+{
+    if (m_pendingTexture) {
+        if (m_uploadStream) {
+            m_uploadStream->cancel(m_pendingTexture.get());
+        }
+        m_pendingTexture.reset();
+    }
+    m_pendingIndex = -1;
+    m_currentTexture.reset();
+    m_tiledImage.reset();
+    m_current_image_path.clear();
+    requestRedraw();
+}
+
+bool PicasaApp::isImagePath(const std::string& path) 
+{
+    if (ExifReader::isRawPath(path)) {
+        return true;
+    }
+    
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".gif";
 }
 
 void PicasaApp::framebufferSizeCallback(GLFWwindow* window, int width, int height) {
@@ -366,6 +1649,14 @@ void PicasaApp::framebufferSizeCallback(GLFWwindow* window, int width, int heigh
         g_appInstance->m_width = width;
         g_appInstance->m_height = height;
         glViewport(0, 0, width, height);
+        g_appInstance->requestRedraw();
+    }
+}
+
+void PicasaApp::windowRefreshCallback(GLFWwindow* /*window*/) {
+    // Exposed or damaged by the window system
+    if (g_appInstance) {
+        g_appInstance->requestRedraw();
     }
 }
 
@@ -375,6 +1666,7 @@ void PicasaApp::keyCallback(GLFWwindow* window, int key, int scancode, int actio
     }
     
     if (action == GLFW_PRESS) {
+        g_appInstance->requestRedraw();
         switch (key) {
             case GLFW_KEY_ESCAPE:
                 glfwSetWindowShouldClose(window, true);
@@ -393,11 +1685,27 @@ void PicasaApp::keyCallback(GLFWwindow* window, int key, int scancode, int actio
                 break;
             case GLFW_KEY_TAB:
                 g_appInstance->m_showThumbnails = !g_appInstance->m_showThumbnails;
+                g_appInstance->m_gridLayout.scrollToItem(g_appInstance->m_currentIndex);
+                break;
+            case GLFW_KEY_PAGE_UP:
+                g_appInstance->m_gridLayout.scrollBy(-static_cast<float>(g_appInstance->m_gridLayout.getViewportHeight()));
+                break;
+            case GLFW_KEY_PAGE_DOWN:
+                g_appInstance->m_gridLayout.scrollBy(static_cast<float>(g_appInstance->m_gridLayout.getViewportHeight()));
+                break;
+            case GLFW_KEY_HOME:
+                g_appInstance->m_gridLayout.setScroll(0.0f);
+                break;
+            case GLFW_KEY_END:
+                g_appInstance->m_gridLayout.setScroll(g_appInstance->m_gridLayout.getMaxScroll());
+                break;
+            case GLFW_KEY_F3:
+                g_appInstance->setShowStats(!g_appInstance->m_showStats);
                 break;
             case GLFW_KEY_SPACE:
                 g_appInstance->m_scale = 1.0f;
                 g_appInstance->m_offset = glm::vec2(0.0f, 0.0f);
-                g_appInstance->m_rotation = 0.0f;
+                g_appInstance->m_rotation = g_appInstance->m_uprightRotation;
                 break;
         }
     }
@@ -407,6 +1715,7 @@ void PicasaApp::mouseButtonCallback(GLFWwindow* window, int button, int action,
     if (!g_appInstance) {
         return;
     }
+    g_appInstance->requestRedraw();
     
     if (button == GLFW_MOUSE_BUTTON_LEFT) 
     {
@@ -419,20 +1728,8 @@ void PicasaApp::mouseButtonCallback(GLFWwindow* window, int button, int action,
             
             if (g_appInstance->m_showThumbnails) 
             {
-                float ndcX = (2.0f * xpos / g_appInstance->m_width) - 1.0f;
-                float ndcY = 1.0f - (2.0f * ypos / g_appInstance->m_height);
-                
-                int cols = g_appInstance->m_width / (g_appInstance->m_thumbnailSize + 10);
-                if (cols < 1) cols = 1;
-                
-                float cellWidth = 2.0f / cols;
-                float cellHeight = cellWidth * (g_appInstance->m_height / static_cast<float>(g_appInstance->m_width));
-                
-                int col = static_cast<int>((ndcX + 1.0f) / cellWidth);
-                int row = static_cast<int>((1.0f - ndcY) / cellHeight);
-                
-                int index = row * cols + col;
-                if (index >= 0 && index < g_appInstance->m_thumbnails.size()) 
+                int index = g_appInstance->m_gridLayout.pick(static_cast<float>(xpos), static_cast<float>(ypos));
+                if (index >= 0 && index < static_cast<int>(g_appInstance->m_imageFiles.size())) 
                 {
                     g_appInstance->m_currentIndex = index;
                     g_appInstance->loadImage(g_appInstance->m_imageFiles[index]);
@@ -462,6 +1759,7 @@ void PicasaApp::cursorPosCallback(GLFWwindow* window, double xpos, double ypos)
 
     g_appInstance->m_offset += delta;
     g_appInstance->m_dragStart = currentPos;
+    g_appInstance->requestRedraw();
 }
 
 void PicasaApp::scrollCallback(GLFWwindow* window, double xoffset, double yoffset) 
@@ -469,6 +1767,13 @@ void PicasaApp::scrollCallback(GLFWwindow* window, double xoffset, double yoffse
     if (!g_appInstance) {
         return;
     }
+    g_appInstance->requestRedraw();
+    
+    if (g_appInstance->m_showThumbnails) {
+        GridLayout& grid = g_appInstance->m_gridLayout;
+        grid.scrollBy(static_cast<float>(-yoffset) * grid.getCellHeight());
+        return;
+    }
     
     if (yoffset > 0) {
         g_appInstance->m_scale *= 1.1f;
@@ -0,0 +1,320 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    pixel_pool.cpp                                                //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "pixel_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const int kMinPooledShift = 16;
+const int kClassesPerDoubling = 4;
+const int kClassCount = (64 - kMinPooledShift) * kClassesPerDoubling;
+const size_t kMaxBlockSize = SIZE_MAX / 4;
+
+static_assert(PixelPool::kMinPooledSize == (size_t(1) << kMinPooledShift), "size classes start at kMinPooledSize");
+
+// Sits in front of every block; 64 bytes keeps the pixels cache line aligned
+struct alignas(64) BlockHeader {
+    size_t size;
+    size_t capacity;
+    int sizeClass;          // -1 for small blocks
+};
+
+struct PoolState {
+    std::mutex mutex;
+    std::vector<BlockHeader*> idle[kClassCount];
+    uint64_t lastReleased[kClassCount] = {};
+    uint64_t releaseCount = 0;
+    size_t inUseBytes = 0;
+    size_t idleBytes = 0;
+    size_t peakBytes = 0;
+    size_t ceilingBytes = size_t(4096) * 1024 * 1024;
+    size_t idleLimitBytes = size_t(256) * 1024 * 1024;
+    uint64_t allocations = 0;
+    uint64_t reused = 0;
+    uint64_t failures = 0;
+};
+
+// Never destroyed, so buffers released during static destruction are safe
+PoolState& state()
+{
+    static PoolState* pool = new PoolState();
+    return *pool;
+}
+
+int classFor(size_t size)
+{
+    int shift = (63 - __builtin_clzll(size)) - kMinPooledShift;
+    size_t base = PixelPool::kMinPooledSize << shift;
+    size_t step = base / kClassesPerDoubling;
+    // A size just past the last step lands on the next power's first class
+    return shift * kClassesPerDoubling + static_cast<int>((size - base + step - 1) / step);
+}
+
+size_t classSize(int sizeClass)
+{
+    size_t base = PixelPool::kMinPooledSize << (sizeClass / kClassesPerDoubling);
+    return base + (base / kClassesPerDoubling) * (sizeClass % kClassesPerDoubling);
+}
+
+BlockHeader* allocateRaw(size_t capacity)
+{
+    void* raw = nullptr;
+    if (posix_memalign(&raw, alignof(BlockHeader), sizeof(BlockHeader) + capacity) != 0) {
+        return nullptr;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(raw);
+    header->capacity = capacity;
+    return header;
+}
+
+BlockHeader* headerOf(const void* block)
+{
+    return const_cast<BlockHeader*>(static_cast<const BlockHeader*>(block)) - 1;
+}
+
+// Least recently released class first, until the idle blocks fit in
+// `idleTarget` and everything in `total`
+void dropIdle(PoolState& pool, size_t idleTarget, size_t total, std::vector<BlockHeader*>& dropped)
+{
+    while (pool.idleBytes > idleTarget || (pool.idleBytes > 0 && pool.inUseBytes + pool.idleBytes > total))
+    {
+        int oldest = -1;
+        for (int c = 0; c < kClassCount; c++) {
+            if (!pool.idle[c].empty() && (oldest < 0 || pool.lastReleased[c] < pool.lastReleased[oldest])) {
+                oldest = c;
+            }
+        }
+        dropped.push_back(pool.idle[oldest].back());
+        pool.idle[oldest].pop_back();
+        pool.idleBytes -= classSize(oldest);
+    }
+}
+
+void freeAll(const std::vector<BlockHeader*>& blocks)
+{
+    for (BlockHeader* header : blocks) {
+        std::free(header);
+    }
+}
+
+} // namespace
+
+void* PixelPool::allocate(size_t size)
+{
+    if (size > kMaxBlockSize) {
+        return nullptr;
+    }
+
+    if (size < kMinPooledSize) {
+        BlockHeader* header = allocateRaw(size);
+        if (!header) {
+            return nullptr;
+        }
+        header->size = size;
+        header->sizeClass = -1;
+        return header + 1;
+    }
+
+    int sizeClass = classFor(size);
+    size_t capacity = classSize(sizeClass);
+    PoolState& pool = state();
+    BlockHeader* header = nullptr;
+    bool reserved = false;
+    std::vector<BlockHeader*> dropped;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.allocations++;
+
+        std::vector<BlockHeader*>& idle = pool.idle[sizeClass];
+        if (!idle.empty()) {
+            header = idle.back();
+            idle.pop_back();
+            pool.idleBytes -= capacity;
+            pool.inUseBytes += capacity;
+            pool.reused++;
+        } else {
+            if (pool.inUseBytes + pool.idleBytes + capacity > pool.ceilingBytes) {
+                size_t room = pool.ceilingBytes - std::min(pool.ceilingBytes, capacity);
+                dropIdle(pool, pool.idleBytes, room, dropped);
+            }
+            if (pool.inUseBytes + capacity > pool.ceilingBytes) {
+                pool.failures++;
+            } else {
+                pool.inUseBytes += capacity;
+                pool.peakBytes = std::max(pool.peakBytes, pool.inUseBytes + pool.idleBytes);
+                reserved = true;
+            }
+        }
+    }
+    freeAll(dropped);
+
+    // The heap is only touched outside the lock
+    if (!header && reserved) {
+        header = allocateRaw(capacity);
+        if (!header) {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            pool.inUseBytes -= capacity;
+            pool.failures++;
+            return nullptr;
+        }
+        header->sizeClass = sizeClass;
+    }
+    if (!header) {
+        return nullptr;
+    }
+
+    header->size = size;
+    return header + 1;
+}
+
+void* PixelPool::reallocate(void* block, size_t size)
+{
+    if (!block) {
+        return allocate(size);
+    }
+
+    BlockHeader* header = headerOf(block);
+    if (size <= header->capacity) {
+        header->size = size;
+        return block;
+    }
+
+    void* grown = allocate(size);
+    if (!grown) {
+        return nullptr;
+    }
+    std::memcpy(grown, block, header->size);
+    release(block);
+    return grown;
+}
+
+void PixelPool::release(void* block)
+{
+    if (!block) {
+        return;
+    }
+
+    BlockHeader* header = headerOf(block);
+    if (header->sizeClass < 0) {
+        std::free(header);
+        return;
+    }
+
+    PoolState& pool = state();
+    size_t capacity = header->capacity;
+    bool kept = false;
+    std::vector<BlockHeader*> dropped;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.inUseBytes -= capacity;
+        // The size just freed is the likeliest to come back, so it displaces older ones
+        if (capacity <= pool.idleLimitBytes && pool.inUseBytes + capacity <= pool.ceilingBytes) {
+            dropIdle(pool, pool.idleLimitBytes - capacity, pool.ceilingBytes - capacity, dropped);
+            pool.idle[header->sizeClass].push_back(header);
+            pool.lastReleased[header->sizeClass] = ++pool.releaseCount;
+            pool.idleBytes += capacity;
+            kept = true;
+        }
+    }
+    freeAll(dropped);
+    if (!kept) {
+        std::free(header);
+    }
+}
+
+size_t PixelPool::getSize(const void* block)
+{
+    return block ? headerOf(block)->size : 0;
+}
+
+void PixelPool::setCeiling(size_t bytes)
+{
+    PoolState& pool = state();
+    std::vector<BlockHeader*> dropped;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.ceilingBytes = bytes;
+        dropIdle(pool, pool.idleBytes, bytes, dropped);
+    }
+    freeAll(dropped);
+}
+
+void PixelPool::setIdleLimit(size_t bytes)
+{
+    PoolState& pool = state();
+    std::vector<BlockHeader*> dropped;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.idleLimitBytes = bytes;
+        dropIdle(pool, bytes, pool.ceilingBytes, dropped);
+    }
+    freeAll(dropped);
+}
+
+void PixelPool::trim()
+{
+    PoolState& pool = state();
+    std::vector<BlockHeader*> dropped;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        dropIdle(pool, 0, pool.ceilingBytes, dropped);
+    }
+    freeAll(dropped);
+}
+
+PixelPoolStats PixelPool::getStats()
+{
+    PoolState& pool = state();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    PixelPoolStats stats;
+    stats.inUseBytes = pool.inUseBytes;
+    stats.idleBytes = pool.idleBytes;
+    stats.peakBytes = pool.peakBytes;
+    stats.ceilingBytes = pool.ceilingBytes;
+    stats.idleLimitBytes = pool.idleLimitBytes;
+    stats.allocations = pool.allocations;
+    stats.reused = pool.reused;
+    stats.failures = pool.failures;
+    return stats;
+}
+
+bool PixelBuffer::resize(size_t size)
+{
+    if (size == 0) {
+        clear();
+        return true;
+    }
+
+    void* block = PixelPool::reallocate(m_data, size);
+    if (!block) {
+        return false;
+    }
+    m_data = static_cast<unsigned char*>(block);
+    m_size = size;
+    return true;
+}
+
+void PixelBuffer::adopt(unsigned char* block)
+{
+    clear();
+    m_data = block;
+    m_size = PixelPool::getSize(block);
+}
+
+void PixelBuffer::clear()
+{
+    PixelPool::release(m_data);
+    m_data = nullptr;
+    m_size = 0;
+}
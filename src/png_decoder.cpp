@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    png_decoder.cpp                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "png_decoder.h"
+#include "input_file.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <png.h>
+
+namespace {
+
+void pngError(png_structp png, png_const_charp message)
+{
+    std::cerr << "libpng: " << message << std::endl;
+    png_longjmp(png, 1);
+}
+
+void pngWarning(png_structp, png_const_charp)
+{
+}
+
+// Chunked over the InputFile; a file truncated while it is decoded fails
+struct FileReader {
+    InputFile* file;
+    uint64_t position;
+    std::vector<unsigned char> buffer;
+    size_t offset;
+    size_t available;
+};
+
+void readFromFile(png_structp png, png_bytep target, png_size_t length)
+{
+    FileReader* reader = static_cast<FileReader*>(png_get_io_ptr(png));
+    while (length > 0) {
+        if (reader->offset == reader->available) {
+            reader->available = reader->file->read(reader->position, reader->buffer.data(), reader->buffer.size());
+            reader->position += reader->available;
+            reader->offset = 0;
+            if (reader->available == 0) {
+                png_error(png, "Read past end of file");
+            }
+        }
+        size_t count = std::min<size_t>(length, reader->available - reader->offset);
+        std::copy(reader->buffer.data() + reader->offset, reader->buffer.data() + reader->offset + count, target);
+        reader->offset += count;
+        target += count;
+        length -= count;
+    }
+}
+
+} // namespace
+
+bool PngDecoder::isPngPath(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".png";
+}
+
+bool PngDecoder::readHeader(const std::string& path, int& width, int& height, bool& hasAlpha, bool& interlaced)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    // Signature (8) + IHDR length/type (8) + IHDR data (13)
+    unsigned char header[29];
+    bool valid = std::fread(header, 1, sizeof(header), file) == sizeof(header) &&
+                 png_sig_cmp(header, 0, 8) == 0;
+    std::fclose(file);
+
+    if (!valid) {
+        return false;
+    }
+
+    auto readUint32 = [&header](int offset) {
+        return (static_cast<uint32_t>(header[offset]) << 24) | (header[offset + 1] << 16) |
+               (header[offset + 2] << 8) | header[offset + 3];
+    };
+
+    width = static_cast<int>(readUint32(16));
+    height = static_cast<int>(readUint32(20));
+    hasAlpha = (header[25] & PNG_COLOR_MASK_ALPHA) != 0;
+    interlaced = header[28] != PNG_INTERLACE_NONE;
+    return width > 0 && height > 0;
+}
+
+bool PngDecoder::decodeRows(const std::string& path, int channels, const RowCallback& onRow,
+                            const std::atomic<bool>* cancel)
+{
+    InputFile file;
+    if (!file.open(path, InputFile::Access::Sequential)) {
+        return false;
+    }
+    DecodeTimer timer;
+    FileReader reader{&file, 0, std::vector<unsigned char>(64 * 1024), 0, 0};
+
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, pngError, pngWarning);
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (!png || !info) {
+        png_destroy_read_struct(&png, nullptr, nullptr);
+        return false;
+    }
+
+    std::vector<unsigned char> buffer;
+
+    if (setjmp(png_jmpbuf(png))) {
+        std::cerr << "Failed to decode PNG: " << path << std::endl;
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
+    }
+
+    png_set_read_fn(png, &reader, readFromFile);
+    png_read_info(png, info);
+
+    png_uint_32 width = png_get_image_width(png, info);
+    png_uint_32 height = png_get_image_height(png, info);
+    int colorType = png_get_color_type(png, info);
+
+    if (png_get_interlace_type(png, info) != PNG_INTERLACE_NONE) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
+    }
+
+    png_set_strip_16(png);
+    png_set_packing(png);
+    if (colorType == PNG_COLOR_TYPE_PALETTE) {
+        png_set_palette_to_rgb(png);
+    }
+    if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA) {
+        png_set_expand_gray_1_2_4_to_8(png);
+        png_set_gray_to_rgb(png);
+    }
+    if (channels == 4 && !(colorType & PNG_COLOR_MASK_ALPHA)) {
+        png_set_add_alpha(png, 0xFF, PNG_FILLER_AFTER);
+    }
+    if (channels == 3 && (colorType & PNG_COLOR_MASK_ALPHA)) {
+        png_set_strip_alpha(png);
+    }
+    png_read_update_info(png, info);
+
+    buffer.resize(png_get_rowbytes(png, info));
+    bool cancelled = false;
+
+    for (png_uint_32 y = 0; y < height; y++) {
+        if (cancel && cancel->load()) {
+            cancelled = true;
+            break;
+        }
+        png_read_row(png, buffer.data(), nullptr);
+        onRow(buffer.data(), static_cast<int>(y));
+    }
+
+    (void)width;
+    png_destroy_read_struct(&png, &info, nullptr);
+
+    return !cancelled;
+}
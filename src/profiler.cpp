@@ -0,0 +1,376 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    profiler.cpp                                                  //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include <unistd.h>
+
+namespace {
+
+// About 150 MB of spans per thread (72 byte events) before new ones are dropped
+const size_t kMaxEventsPerTrack = 1u << 21;
+const int64_t kStatsWindowNs = 500000000;
+const size_t kMaxGpuQueries = 64;
+
+struct Event {
+    const char* name;
+    int64_t start;
+    int64_t duration;
+    double value;           // counters only
+    char phase;             // 'X' span, 'C' counter
+    std::string detail;
+};
+
+struct Track {
+    std::mutex mutex;
+    int id = 0;
+    std::string name;
+    std::vector<Event> events;
+    size_t dropped = 0;
+};
+
+std::atomic<bool> g_stats(false);
+std::atomic<bool> g_tracing(false);
+
+std::mutex g_tracksMutex;
+std::vector<std::shared_ptr<Track>> g_tracks;
+std::string g_tracePath;
+
+thread_local std::shared_ptr<Track> t_track;
+thread_local bool t_frameThread = false;
+
+// Touched by the frame thread only
+struct StatsWindow {
+    std::vector<Profiler::ScopeStats> scopes;
+    int frames = 0;
+    double frameSum = 0.0;
+    double worstFrame = 0.0;
+    int64_t start = -1;
+    int64_t frameStart = -1;
+    Profiler::FrameStats published;
+} g_window;
+
+Track& currentTrack()
+{
+    if (!t_track) {
+        t_track = std::make_shared<Track>();
+        std::lock_guard<std::mutex> lock(g_tracksMutex);
+        t_track->id = static_cast<int>(g_tracks.size()) + 1;
+        t_track->name = "thread " + std::to_string(t_track->id);
+        g_tracks.push_back(t_track);
+    }
+    return *t_track;
+}
+
+void addEvent(Event event)
+{
+    Track& track = currentTrack();
+    std::lock_guard<std::mutex> lock(track.mutex);
+    if (track.events.size() < kMaxEventsPerTrack) {
+        track.events.push_back(std::move(event));
+    } else {
+        track.dropped++;
+    }
+}
+
+Profiler::ScopeStats& windowScope(const char* name)
+{
+    for (Profiler::ScopeStats& scope : g_window.scopes) {
+        if (scope.name == name || std::strcmp(scope.name, name) == 0) {
+            return scope;
+        }
+    }
+    g_window.scopes.push_back(Profiler::ScopeStats{name});
+    return g_window.scopes.back();
+}
+
+void writeEscaped(FILE* file, const std::string& text)
+{
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(c, file);
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            std::fputc(c, file);
+        }
+    }
+}
+
+} // namespace
+
+std::atomic<bool> Profiler::s_active(false);
+
+void Profiler::setStatsEnabled(bool enabled)
+{
+    g_stats = enabled;
+    s_active = g_stats.load() || g_tracing.load();
+}
+
+bool Profiler::isStatsEnabled()
+{
+    return g_stats.load();
+}
+
+bool Profiler::startTrace(const std::string& path)
+{
+    // Fail now rather than after a long session
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Failed to open trace file " << path << std::endl;
+        return false;
+    }
+    std::fclose(file);
+
+    {
+        std::lock_guard<std::mutex> lock(g_tracksMutex);
+        g_tracePath = path;
+        for (auto& track : g_tracks) {
+            std::lock_guard<std::mutex> trackLock(track->mutex);
+            track->events.clear();
+            track->dropped = 0;
+        }
+    }
+    now();
+    g_tracing = true;
+    s_active = true;
+    return true;
+}
+
+bool Profiler::stopTrace()
+{
+    if (!g_tracing.exchange(false)) {
+        return false;
+    }
+    s_active = g_stats.load();
+
+    std::lock_guard<std::mutex> lock(g_tracksMutex);
+    FILE* file = std::fopen(g_tracePath.c_str(), "w");
+    if (!file) {
+        std::cerr << "Failed to write trace file " << g_tracePath << std::endl;
+        return false;
+    }
+
+    int pid = static_cast<int>(::getpid());
+    size_t dropped = 0;
+    bool first = true;
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for (auto& track : g_tracks)
+    {
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> trackLock(track->mutex);
+            events.swap(track->events);
+            dropped += track->dropped;
+            track->dropped = 0;
+        }
+        if (events.empty()) {
+            continue;
+        }
+
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"",
+                     first ? "" : ",\n", pid, track->id);
+        writeEscaped(file, track->name);
+        std::fprintf(file, "\"}}");
+        first = false;
+
+        for (const Event& event : events)
+        {
+            if (event.phase == 'C') {
+                std::fprintf(file, ",\n{\"name\":\"GPU ms\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"",
+                             event.start / 1000.0, pid, track->id);
+                writeEscaped(file, event.name);
+                std::fprintf(file, "\":%.4f}}", event.value);
+                continue;
+            }
+
+            std::fprintf(file, ",\n{\"name\":\"");
+            writeEscaped(file, event.name);
+            std::fprintf(file, "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d",
+                         event.start / 1000.0, event.duration / 1000.0, pid, track->id);
+            if (!event.detail.empty()) {
+                std::fprintf(file, ",\"args\":{\"detail\":\"");
+                writeEscaped(file, event.detail);
+                std::fprintf(file, "\"}");
+            }
+            std::fprintf(file, "}");
+        }
+    }
+
+    std::fprintf(file, "\n]}\n");
+    bool ok = std::fclose(file) == 0;
+    if (!ok) {
+        std::cerr << "Failed to write trace file " << g_tracePath << std::endl;
+    }
+    if (dropped > 0) {
+        std::cerr << "Trace dropped " << dropped << " spans past the per-thread limit" << std::endl;
+    }
+    return ok;
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+    Track& track = currentTrack();
+    std::lock_guard<std::mutex> lock(g_tracksMutex);
+    track.name = name;
+}
+
+int64_t Profiler::now()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::record(const char* name, int64_t start, int64_t end, const std::string* detail)
+{
+    if (t_frameThread && g_stats.load(std::memory_order_relaxed)) {
+        windowScope(name).cpuMs += (end - start) / 1e6;
+    }
+    if (g_tracing.load(std::memory_order_relaxed)) {
+        addEvent(Event{name, start, end - start, 0.0, 'X', detail ? *detail : std::string()});
+    }
+}
+
+void Profiler::recordGpu(const char* pass, double milliseconds)
+{
+    if (t_frameThread && g_stats.load(std::memory_order_relaxed)) {
+        windowScope(pass).gpuMs += milliseconds;
+    }
+    if (g_tracing.load(std::memory_order_relaxed)) {
+        addEvent(Event{pass, now(), 0, milliseconds, 'C', std::string()});
+    }
+}
+
+void Profiler::beginFrame()
+{
+    t_frameThread = true;
+    g_window.frameStart = now();
+    if (g_window.start < 0) {
+        g_window.start = g_window.frameStart;
+    }
+}
+
+void Profiler::endFrame()
+{
+    if (g_window.frameStart < 0) {
+        return;
+    }
+    int64_t time = now();
+    if (g_tracing.load(std::memory_order_relaxed)) {
+        addEvent(Event{"frame", g_window.frameStart, time - g_window.frameStart, 0.0, 'X', std::string()});
+    }
+
+    double frameMs = (time - g_window.frameStart) / 1e6;
+    g_window.frameStart = -1;
+    g_window.frames++;
+    g_window.frameSum += frameMs;
+    g_window.worstFrame = std::max(g_window.worstFrame, frameMs);
+    if (time - g_window.start < kStatsWindowNs) {
+        return;
+    }
+
+    // Publish per-frame averages and start the next window; rows keep their order
+    FrameStats& stats = g_window.published;
+    stats.frameMs = g_window.frameSum / g_window.frames;
+    stats.worstFrameMs = g_window.worstFrame;
+    // From the summed frame times: the idle waits between frames are not frames
+    stats.fps = (g_window.frameSum > 0.0) ? g_window.frames * 1000.0 / g_window.frameSum : 0.0;
+    stats.scopes = g_window.scopes;
+    for (ScopeStats& scope : stats.scopes) {
+        scope.cpuMs /= g_window.frames;
+        scope.gpuMs /= g_window.frames;
+    }
+
+    for (ScopeStats& scope : g_window.scopes) {
+        scope.cpuMs = 0.0;
+        scope.gpuMs = 0.0;
+    }
+    g_window.frames = 0;
+    g_window.frameSum = 0.0;
+    g_window.worstFrame = 0.0;
+    g_window.start = -1;
+}
+
+const Profiler::FrameStats& Profiler::getFrameStats()
+{
+    return g_window.published;
+}
+
+GpuTimer::GpuTimer()
+    : m_running(false)
+{
+}
+
+GpuTimer::~GpuTimer()
+{
+    for (GLuint id : m_free) {
+        glDeleteQueries(1, &id);
+    }
+    for (const Query& query : m_inFlight) {
+        glDeleteQueries(1, &query.id);
+    }
+}
+
+bool GpuTimer::begin(const char* pass)
+{
+    if (m_running) {
+        return false;
+    }
+
+    GLuint id = 0;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+    } else if (m_inFlight.size() < kMaxGpuQueries) {
+        glGenQueries(1, &id);
+    }
+    if (id == 0) {
+        return false;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, id);
+    m_inFlight.push_back(Query{id, pass});
+    m_running = true;
+    return true;
+}
+
+void GpuTimer::end()
+{
+    if (m_running) {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_running = false;
+    }
+}
+
+void GpuTimer::collect()
+{
+    // Queries complete in submission order, so stop at the first pending one
+    while (!m_inFlight.empty() && !(m_running && m_inFlight.size() == 1))
+    {
+        const Query& query = m_inFlight.front();
+        GLint available = 0;
+        glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &nanoseconds);
+        Profiler::recordGpu(query.pass, nanoseconds / 1e6);
+        m_free.push_back(query.id);
+        m_inFlight.pop_front();
+    }
+}
@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    read_ahead_pool.cpp                                           //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "read_ahead_pool.h"
+#include "input_file.h"
+#include "profiler.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ReadAheadPool::ReadAheadPool()
+    : m_aheadBytes(0),
+      m_byteBudget(0),
+      m_generation(0),
+      m_stopping(false)
+{
+}
+
+ReadAheadPool::~ReadAheadPool()
+{
+    stop();
+}
+
+void ReadAheadPool::start(unsigned threadCount, size_t byteBudget)
+{
+    if (!m_threads.empty()) {
+        return;
+    }
+
+    m_byteBudget = byteBudget;
+    m_stopping = false;
+    for (unsigned i = 0; i < std::max(1u, threadCount); i++) {
+        m_threads.emplace_back(&ReadAheadPool::threadLoop, this);
+    }
+}
+
+void ReadAheadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+    clear();
+}
+
+void ReadAheadPool::enqueue(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_threads.empty() || m_ahead.count(path)) {
+            return;
+        }
+        m_queue.push_back(path);
+    }
+    m_condition.notify_one();
+}
+
+void ReadAheadPool::consume(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_ahead.find(path);
+    if (it != m_ahead.end()) {
+        m_aheadBytes -= it->second;
+        m_ahead.erase(it);
+        m_condition.notify_all();
+        return;
+    }
+
+    // Not started yet; the worker's own read makes this one pointless
+    auto queued = std::find(m_queue.begin(), m_queue.end(), path);
+    if (queued != m_queue.end()) {
+        m_queue.erase(queued);
+    }
+}
+
+void ReadAheadPool::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    m_ahead.clear();
+    m_aheadBytes = 0;
+    m_generation++;
+    m_condition.notify_all();
+}
+
+void ReadAheadPool::threadLoop()
+{
+    Profiler::setThreadName("read ahead");
+
+    for (;;)
+    {
+        std::string path;
+        uint64_t generation;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return m_stopping || (!m_queue.empty() && m_aheadBytes < m_byteBudget);
+            });
+            if (m_stopping) {
+                return;
+            }
+
+            path = std::move(m_queue.front());
+            m_queue.pop_front();
+            generation = m_generation;
+            // Claimed before reading, so a worker that gets there first can consume it
+            if (!m_ahead.emplace(path, 0).second) {
+                continue;
+            }
+        }
+
+        size_t bytes = 0;
+        if (!m_filter || m_filter(path))
+        {
+            PROFILE_SCOPE_DETAIL("readahead", path);
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat st;
+            if (fd >= 0 && ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+                bytes = static_cast<size_t>(st.st_size);
+                ::readahead(fd, 0, bytes);
+                IoStatistics::addReadAhead(bytes);
+            }
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_ahead.find(path);
+        if (generation == m_generation && it != m_ahead.end()) {
+            it->second = bytes;
+            m_aheadBytes += bytes;
+        }
+    }
+}
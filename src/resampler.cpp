@@ -0,0 +1,288 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    resampler.cpp                                                 //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "resampler.h"
+#include "resampler_kernels.h"
+#include "pixel_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+struct Contributors {
+    int taps;
+    std::vector<int> start;
+    std::vector<int16_t> weights;
+};
+
+double filterSupport(Resampler::Filter filter)
+{
+    switch (filter) {
+        case Resampler::Filter::Box: return 0.5;
+        case Resampler::Filter::Triangle: return 1.0;
+        case Resampler::Filter::Lanczos3: return 3.0;
+    }
+    return 1.0;
+}
+
+double sinc(double x)
+{
+    if (x == 0.0) {
+        return 1.0;
+    }
+    x *= M_PI;
+    return std::sin(x) / x;
+}
+
+// Weight of the source pixel covering [x - 0.5, x + 0.5) in kernel space
+double filterWeight(Resampler::Filter filter, double x, double scale)
+{
+    switch (filter) {
+        case Resampler::Filter::Box: {
+            // Exact coverage, so non-integer ratios average areas like stbir does
+            double lo = std::max(x - 0.5 * scale, -0.5);
+            double hi = std::min(x + 0.5 * scale, 0.5);
+            return std::max(0.0, hi - lo) / scale;
+        }
+        case Resampler::Filter::Triangle:
+            return std::max(0.0, 1.0 - std::fabs(x));
+        case Resampler::Filter::Lanczos3:
+            return (std::fabs(x) < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+    }
+    return 0.0;
+}
+
+// Every output gets the same number of taps inside [0, sourceSize); taps
+// beyond the edge fold onto the edge pixel, which is stbir's clamp mode.
+Contributors computeContributors(int sourceSize, int targetSize, Resampler::Filter filter)
+{
+    double ratio = static_cast<double>(sourceSize) / targetSize;
+    double filterScale = std::max(ratio, 1.0);
+    double support = filterSupport(filter) * filterScale;
+    // Box coverage reaches half a source pixel past the kernel on each side
+    double reach = support + ((filter == Resampler::Filter::Box) ? 0.5 : 0.0);
+    double pixelWidth = 1.0 / filterScale;
+
+    // Clamped weights per output first, the common tap count is their widest span
+    std::vector<int> first(targetSize);
+    std::vector<std::vector<double>> spans(targetSize);
+    int taps = 1;
+    for (int x = 0; x < targetSize; ++x)
+    {
+        double center = (x + 0.5) * ratio;
+        int lo = static_cast<int>(std::floor(center - reach));
+        int hi = static_cast<int>(std::ceil(center + reach));
+        int clampedLo = std::max(0, std::min(lo, sourceSize - 1));
+        int clampedHi = std::max(0, std::min(hi, sourceSize - 1));
+
+        std::vector<double>& span = spans[x];
+        span.assign(clampedHi - clampedLo + 1, 0.0);
+        for (int s = lo; s <= hi; ++s)
+        {
+            double u = (s + 0.5 - center) / filterScale;
+            double w = (filter == Resampler::Filter::Box) ? filterWeight(filter, u, pixelWidth)
+                                                          : filterWeight(filter, u, 1.0);
+            span[std::max(0, std::min(s, sourceSize - 1)) - clampedLo] += w;
+        }
+
+        // Trim zero weights off both ends before measuring the span
+        size_t begin = 0;
+        size_t end = span.size();
+        while (begin + 1 < end && span[begin] == 0.0) {
+            ++begin;
+        }
+        while (end - 1 > begin && span[end - 1] == 0.0) {
+            --end;
+        }
+        span = std::vector<double>(span.begin() + begin, span.begin() + end);
+        first[x] = clampedLo + static_cast<int>(begin);
+        taps = std::max(taps, static_cast<int>(span.size()));
+    }
+
+    Contributors result;
+    result.taps = taps;
+    result.start.resize(targetSize);
+    result.weights.assign(static_cast<size_t>(targetSize) * taps, 0);
+    const double one = static_cast<double>(1 << kResampleWeightBits);
+
+    for (int x = 0; x < targetSize; ++x)
+    {
+        const std::vector<double>& span = spans[x];
+        int start = std::min(first[x], sourceSize - taps);
+        int offset = first[x] - start;
+
+        double total = 0.0;
+        for (double w : span) {
+            total += w;
+        }
+
+        // Round to fixed point and put the rounding error on the largest tap,
+        // so flat areas come back exactly
+        int16_t* out = &result.weights[static_cast<size_t>(x) * taps];
+        int sum = 0;
+        int largest = offset;
+        for (size_t i = 0; i < span.size(); ++i)
+        {
+            int t = offset + static_cast<int>(i);
+            double w = (total != 0.0) ? span[i] / total : 0.0;
+            out[t] = static_cast<int16_t>(std::lround(w * one));
+            sum += out[t];
+            if (std::abs(out[t]) > std::abs(out[largest])) {
+                largest = t;
+            }
+        }
+        out[largest] = static_cast<int16_t>(out[largest] + (1 << kResampleWeightBits) - sum);
+        result.start[x] = start;
+    }
+
+    return result;
+}
+
+struct KernelSet {
+    ResampleHorizontalKernel horizontal;
+    ResampleVerticalKernel vertical;
+};
+
+KernelSet kernelsFor(Resampler::Isa isa)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (isa == Resampler::Isa::Avx2) {
+        return {resampleHorizontalAvx2, resampleVerticalAvx2};
+    }
+    if (isa == Resampler::Isa::Sse2) {
+        return {resampleHorizontalSse2, resampleVerticalSse2};
+    }
+#endif
+    (void)isa;
+    return {resampleHorizontalScalar, resampleVerticalScalar};
+}
+
+std::atomic<int>& selectedIsa()
+{
+    static std::atomic<int> isa(static_cast<int>(Resampler::getBestIsa()));
+    return isa;
+}
+
+inline unsigned char clampPixel(int value)
+{
+    value >>= kResampleWeightBits;
+    return static_cast<unsigned char>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+} // namespace
+
+void resampleHorizontalScalar(const unsigned char* row, const unsigned char*, unsigned char* target,
+                              int targetWidth, int channels, const int* start, const int16_t* weights, int taps)
+{
+    for (int x = 0; x < targetWidth; ++x)
+    {
+        const unsigned char* source = row + static_cast<size_t>(start[x]) * channels;
+        const int16_t* w = weights + static_cast<size_t>(x) * taps;
+        for (int c = 0; c < channels; ++c)
+        {
+            int sum = 1 << (kResampleWeightBits - 1);
+            for (int t = 0; t < taps; ++t) {
+                sum += w[t] * source[t * channels + c];
+            }
+            target[x * channels + c] = clampPixel(sum);
+        }
+    }
+}
+
+void resampleVerticalScalar(const unsigned char* const* rows, const int16_t* weights, int taps,
+                            unsigned char* target, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        int sum = 1 << (kResampleWeightBits - 1);
+        for (int t = 0; t < taps; ++t) {
+            sum += weights[t] * rows[t][i];
+        }
+        target[i] = clampPixel(sum);
+    }
+}
+
+bool Resampler::resize(const unsigned char* source, int sourceWidth, int sourceHeight, int channels,
+                       unsigned char* target, int targetWidth, int targetHeight, Filter filter)
+{
+    if (!source || !target || channels < 1 || channels > 4 ||
+        sourceWidth <= 0 || sourceHeight <= 0 || targetWidth <= 0 || targetHeight <= 0) {
+        return false;
+    }
+
+    KernelSet kernels = kernelsFor(getIsa());
+    Contributors columns = computeContributors(sourceWidth, targetWidth, filter);
+    Contributors rows = computeContributors(sourceHeight, targetHeight, filter);
+
+    // Only the source rows some output row reads need the horizontal pass
+    int firstRow = rows.start.front();
+    int lastRow = rows.start.back() + rows.taps;
+    size_t sourceStride = static_cast<size_t>(sourceWidth) * channels;
+    size_t targetStride = static_cast<size_t>(targetWidth) * channels;
+
+    PixelBuffer intermediate;
+    if (!intermediate.resize(static_cast<size_t>(lastRow - firstRow) * targetStride)) {
+        return false;
+    }
+    for (int y = firstRow; y < lastRow; ++y)
+    {
+        const unsigned char* row = source + y * sourceStride;
+        kernels.horizontal(row, row + sourceStride, &intermediate[(y - firstRow) * targetStride],
+                           targetWidth, channels, columns.start.data(), columns.weights.data(), columns.taps);
+    }
+
+    std::vector<const unsigned char*> rowPointers(rows.taps);
+    for (int y = 0; y < targetHeight; ++y)
+    {
+        for (int t = 0; t < rows.taps; ++t) {
+            rowPointers[t] = &intermediate[(rows.start[y] + t - firstRow) * targetStride];
+        }
+        kernels.vertical(rowPointers.data(), &rows.weights[static_cast<size_t>(y) * rows.taps], rows.taps,
+                         target + y * targetStride, targetStride);
+    }
+
+    return true;
+}
+
+Resampler::Isa Resampler::getIsa()
+{
+    return static_cast<Isa>(selectedIsa().load(std::memory_order_relaxed));
+}
+
+Resampler::Isa Resampler::getBestIsa()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::Avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return Isa::Sse2;
+    }
+#endif
+    return Isa::Scalar;
+}
+
+void Resampler::setIsa(Isa isa)
+{
+    Isa best = getBestIsa();
+    selectedIsa().store(static_cast<int>(std::min(isa, best)), std::memory_order_relaxed);
+}
+
+const char* Resampler::getIsaName(Isa isa)
+{
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::Sse2: return "sse2";
+        case Isa::Avx2: return "avx2";
+    }
+    return "unknown";
+}
@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    resampler_avx2.cpp                                            //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "resampler_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cstring>
+#include <immintrin.h>
+
+// Compiled for AVX2 per function so the rest of the build keeps its flags;
+// Resampler only calls in here after checking the CPU
+#define RESAMPLER_AVX2 __attribute__((target("avx2")))
+
+namespace {
+
+template <int C>
+RESAMPLER_AVX2 inline __m128i loadPixel(const unsigned char* p, const unsigned char* rowEnd)
+{
+    // A whole word is one load; the stray fourth byte lands in a lane that is never stored
+    uint32_t value = 0;
+    if (C == 3 && p + 4 <= rowEnd) {
+        std::memcpy(&value, p, 4);
+    } else {
+        std::memcpy(&value, p, C);
+    }
+    return _mm_cvtsi32_si128(static_cast<int>(value));
+}
+
+RESAMPLER_AVX2 inline int weightPair(int16_t a, int16_t b)
+{
+    return static_cast<int>(static_cast<uint16_t>(a) | (static_cast<uint32_t>(static_cast<uint16_t>(b)) << 16));
+}
+
+// Byte shuffle that turns four packed pixels into (p0,p1) and (p2,p3)
+// channel pairs, ready for widening and madd; absent channels read zero
+template <int C>
+RESAMPLER_AVX2 inline __m128i pairShuffle()
+{
+    alignas(16) char mask[16];
+    for (int half = 0; half < 2; ++half) {
+        for (int c = 0; c < 4; ++c) {
+            for (int p = 0; p < 2; ++p) {
+                int pixel = half * 2 + p;
+                mask[half * 8 + c * 2 + p] = (c < C) ? static_cast<char>(pixel * C + c) : static_cast<char>(0x80);
+            }
+        }
+    }
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+// Four taps per iteration: one 16-byte load covers four pixels of any
+// channel count, with a bounce buffer near the end of the row
+template <int C>
+RESAMPLER_AVX2 void horizontal(const unsigned char* row, const unsigned char* rowEnd, unsigned char* target,
+                               int targetWidth, const int* start, const int16_t* weights, int taps)
+{
+    const __m128i shuffle = pairShuffle<C>();
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int x = 0; x < targetWidth; ++x)
+    {
+        const unsigned char* source = row + static_cast<size_t>(start[x]) * C;
+        const int16_t* w = weights + static_cast<size_t>(x) * taps;
+        __m256i wide = _mm256_setzero_si256();
+        __m128i sum = _mm_set1_epi32(1 << (kResampleWeightBits - 1));
+
+        int t = 0;
+        for (; t + 3 < taps; t += 4)
+        {
+            const unsigned char* p = source + t * C;
+            __m128i pixels;
+            if (p + 16 <= rowEnd) {
+                pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            } else {
+                alignas(16) unsigned char bounce[16] = {};
+                std::memcpy(bounce, p, 4 * C);
+                pixels = _mm_load_si128(reinterpret_cast<const __m128i*>(bounce));
+            }
+            __m256i values = _mm256_cvtepu8_epi16(_mm_shuffle_epi8(pixels, shuffle));
+            int w01 = weightPair(w[t], w[t + 1]);
+            int w23 = weightPair(w[t + 2], w[t + 3]);
+            __m256i pairs = _mm256_setr_epi32(w01, w01, w01, w01, w23, w23, w23, w23);
+            wide = _mm256_add_epi32(wide, _mm256_madd_epi16(values, pairs));
+        }
+        for (; t < taps; t += 2)
+        {
+            bool pair = t + 1 < taps;
+            __m128i b = pair ? loadPixel<C>(source + (t + 1) * C, rowEnd) : zero;
+            __m128i values = _mm_unpacklo_epi8(_mm_unpacklo_epi8(loadPixel<C>(source + t * C, rowEnd), b), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(values, _mm_set1_epi32(weightPair(w[t], pair ? w[t + 1] : 0))));
+        }
+
+        sum = _mm_add_epi32(sum, _mm_add_epi32(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1)));
+        sum = _mm_srai_epi32(sum, kResampleWeightBits);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(sum, sum), zero);
+        uint32_t value = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+        std::memcpy(target + x * C, &value, C);
+    }
+}
+
+} // namespace
+
+RESAMPLER_AVX2 void resampleHorizontalAvx2(const unsigned char* row, const unsigned char* rowEnd, unsigned char* target,
+                                           int targetWidth, int channels, const int* start, const int16_t* weights, int taps)
+{
+    switch (channels) {
+        case 1: horizontal<1>(row, rowEnd, target, targetWidth, start, weights, taps); break;
+        case 2: horizontal<2>(row, rowEnd, target, targetWidth, start, weights, taps); break;
+        case 3: horizontal<3>(row, rowEnd, target, targetWidth, start, weights, taps); break;
+        default: horizontal<4>(row, rowEnd, target, targetWidth, start, weights, taps); break;
+    }
+}
+
+// Thirty-two bytes at a time. Unpack and pack both work within 128-bit
+// lanes, so the lane split cancels out and bytes come back in order.
+RESAMPLER_AVX2 void resampleVerticalAvx2(const unsigned char* const* rows, const int16_t* weights, int taps,
+                                         unsigned char* target, size_t bytes)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rounding = _mm256_set1_epi32(1 << (kResampleWeightBits - 1));
+
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32)
+    {
+        __m256i sum0 = rounding;
+        __m256i sum1 = rounding;
+        __m256i sum2 = rounding;
+        __m256i sum3 = rounding;
+
+        for (int t = 0; t < taps; t += 2)
+        {
+            bool pair = t + 1 < taps;
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[t] + i));
+            __m256i b = pair ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[t + 1] + i)) : zero;
+            __m256i w = _mm256_set1_epi32(weightPair(weights[t], pair ? weights[t + 1] : 0));
+
+            __m256i lo = _mm256_unpacklo_epi8(a, b);
+            __m256i hi = _mm256_unpackhi_epi8(a, b);
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+            sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+            sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+        }
+
+        __m256i low = _mm256_packs_epi32(_mm256_srai_epi32(sum0, kResampleWeightBits), _mm256_srai_epi32(sum1, kResampleWeightBits));
+        __m256i high = _mm256_packs_epi32(_mm256_srai_epi32(sum2, kResampleWeightBits), _mm256_srai_epi32(sum3, kResampleWeightBits));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), _mm256_packus_epi16(low, high));
+    }
+
+    for (; i < bytes; ++i)
+    {
+        int sum = 1 << (kResampleWeightBits - 1);
+        for (int t = 0; t < taps; ++t) {
+            sum += weights[t] * rows[t][i];
+        }
+        sum >>= kResampleWeightBits;
+        target[i] = static_cast<unsigned char>(sum < 0 ? 0 : (sum > 255 ? 255 : sum));
+    }
+}
+
+#endif
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    resampler_sse2.cpp                                            //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "resampler_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cstring>
+#include <emmintrin.h>
+
+// SSE2 is baseline on x86-64; the attribute only matters for 32-bit builds
+#define RESAMPLER_SSE2 __attribute__((target("sse2")))
+
+namespace {
+
+// One pixel widened to four bytes in the low lane
+template <int C>
+RESAMPLER_SSE2 inline __m128i loadPixel(const unsigned char* p, const unsigned char* rowEnd)
+{
+    // A whole word is one load; the stray fourth byte lands in a lane that is never stored
+    uint32_t value = 0;
+    if (C == 3 && p + 4 <= rowEnd) {
+        std::memcpy(&value, p, 4);
+    } else {
+        std::memcpy(&value, p, C);
+    }
+    return _mm_cvtsi32_si128(static_cast<int>(value));
+}
+
+RESAMPLER_SSE2 inline __m128i weightPair(int16_t a, int16_t b)
+{
+    return _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(a) | (static_cast<uint32_t>(static_cast<uint16_t>(b)) << 16)));
+}
+
+// Per output pixel: two taps per madd, pixels interleaved channel by channel
+template <int C>
+RESAMPLER_SSE2 void horizontal(const unsigned char* row, const unsigned char* rowEnd, unsigned char* target, int targetWidth,
+                               const int* start, const int16_t* weights, int taps)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(1 << (kResampleWeightBits - 1));
+
+    for (int x = 0; x < targetWidth; ++x)
+    {
+        const unsigned char* source = row + static_cast<size_t>(start[x]) * C;
+        const int16_t* w = weights + static_cast<size_t>(x) * taps;
+        __m128i sum = rounding;
+
+        int t = 0;
+        for (; t + 1 < taps; t += 2)
+        {
+            __m128i pair = _mm_unpacklo_epi8(loadPixel<C>(source + t * C, rowEnd), loadPixel<C>(source + (t + 1) * C, rowEnd));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(pair, zero), weightPair(w[t], w[t + 1])));
+        }
+        if (t < taps)
+        {
+            __m128i single = _mm_unpacklo_epi8(loadPixel<C>(source + t * C, rowEnd), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(single, zero), weightPair(w[t], 0)));
+        }
+
+        sum = _mm_srai_epi32(sum, kResampleWeightBits);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(sum, sum), zero);
+        uint32_t value = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+        std::memcpy(target + x * C, &value, C);
+    }
+}
+
+} // namespace
+
+RESAMPLER_SSE2 void resampleHorizontalSse2(const unsigned char* row, const unsigned char* rowEnd, unsigned char* target,
+                                           int targetWidth, int channels, const int* start, const int16_t* weights, int taps)
+{
+    switch (channels) {
+        case 1: horizontal<1>(row, rowEnd, target, targetWidth, start, weights, taps); break;
+        case 2: horizontal<2>(row, rowEnd, target, targetWidth, start, weights, taps); break;
+        case 3: horizontal<3>(row, rowEnd, target, targetWidth, start, weights, taps); break;
+        default: horizontal<4>(row, rowEnd, target, targetWidth, start, weights, taps); break;
+    }
+}
+
+// Sixteen bytes at a time, two source rows per madd
+RESAMPLER_SSE2 void resampleVerticalSse2(const unsigned char* const* rows, const int16_t* weights, int taps,
+                                         unsigned char* target, size_t bytes)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(1 << (kResampleWeightBits - 1));
+
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i sum0 = rounding;
+        __m128i sum1 = rounding;
+        __m128i sum2 = rounding;
+        __m128i sum3 = rounding;
+
+        for (int t = 0; t < taps; t += 2)
+        {
+            bool pair = t + 1 < taps;
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t] + i));
+            __m128i b = pair ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t + 1] + i)) : zero;
+            __m128i w = weightPair(weights[t], pair ? weights[t + 1] : 0);
+
+            __m128i lo = _mm_unpacklo_epi8(a, b);
+            __m128i hi = _mm_unpackhi_epi8(a, b);
+            sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+            sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+            sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+            sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+        }
+
+        __m128i low = _mm_packs_epi32(_mm_srai_epi32(sum0, kResampleWeightBits), _mm_srai_epi32(sum1, kResampleWeightBits));
+        __m128i high = _mm_packs_epi32(_mm_srai_epi32(sum2, kResampleWeightBits), _mm_srai_epi32(sum3, kResampleWeightBits));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_packus_epi16(low, high));
+    }
+
+    for (; i < bytes; ++i)
+    {
+        int sum = 1 << (kResampleWeightBits - 1);
+        for (int t = 0; t < taps; ++t) {
+            sum += weights[t] * rows[t][i];
+        }
+        sum >>= kResampleWeightBits;
+        target[i] = static_cast<unsigned char>(sum < 0 ? 0 : (sum > 255 ? 255 : sum));
+    }
+}
+
+#endif
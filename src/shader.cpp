@@ -10,8 +10,36 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 #include <glm/gtc/type_ptr.hpp>
 
+namespace {
+
+bool isIntType(GLenum type)
+{
+    switch (type) {
+    case GL_INT:
+    case GL_BOOL:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+template <typename T> struct UniformType;
+template <> struct UniformType<int> { static bool matches(GLenum type) { return isIntType(type); } };
+template <> struct UniformType<float> { static bool matches(GLenum type) { return type == GL_FLOAT; } };
+template <> struct UniformType<glm::vec2> { static bool matches(GLenum type) { return type == GL_FLOAT_VEC2; } };
+template <> struct UniformType<glm::vec3> { static bool matches(GLenum type) { return type == GL_FLOAT_VEC3; } };
+template <> struct UniformType<glm::vec4> { static bool matches(GLenum type) { return type == GL_FLOAT_VEC4; } };
+template <> struct UniformType<glm::mat4> { static bool matches(GLenum type) { return type == GL_FLOAT_MAT4; } };
+
+} // namespace
+
 Shader::Shader() : m_id(0) {
 }
 
@@ -81,6 +109,58 @@ bool Shader::loadFromSource(const std::string& vertexSource, const std::string&
     return true;
 }
 
+bool Shader::loadFromBinary(GLenum format, const void* data, GLsizei length)
+{
+    if (m_id != 0) {
+        glDeleteProgram(m_id);
+        m_uniforms.clear();
+    }
+    
+    m_id = glCreateProgram();
+    glProgramBinary(m_id, format, data, length);
+    
+    // Driver updates invalidate old binaries; the caller compiles instead
+    GLint success = 0;
+    glGetProgramiv(m_id, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(m_id);
+        m_id = 0;
+        return false;
+    }
+    
+    queryUniforms();
+    return true;
+}
+
+bool Shader::getBinary(GLenum& format, std::vector<unsigned char>& data) const
+{
+    if (m_id == 0 || !isBinarySupported()) {
+        return false;
+    }
+    
+    GLint length = 0;
+    glGetProgramiv(m_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+    
+    data.resize(static_cast<size_t>(length));
+    GLsizei written = 0;
+    glGetProgramBinary(m_id, length, &written, &format, data.data());
+    data.resize(static_cast<size_t>(written));
+    return written > 0;
+}
+
+bool Shader::isBinarySupported()
+{
+    if (!GLEW_ARB_get_program_binary) {
+        return false;
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
 void Shader::use() {
     glUseProgram(m_id);
 }
@@ -137,10 +217,13 @@ bool Shader::linkProgram(GLuint vertexShader, GLuint fragmentShader)
 {
     if (m_id != 0) {
         glDeleteProgram(m_id);
-        m_uniformLocations.clear();
+        m_uniforms.clear();
     }
     
     m_id = glCreateProgram();
+    if (isBinarySupported()) {
+        glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glAttachShader(m_id, vertexShader);
     glAttachShader(m_id, fragmentShader);
     glLinkProgram(m_id);
@@ -158,21 +241,87 @@ bool Shader::linkProgram(GLuint vertexShader, GLuint fragmentShader)
         return false;
     }
     
+    queryUniforms();
     return true;
 }
 
-GLint Shader::getUniformLocation(const std::string& name) {
-    auto it = m_uniformLocations.find(name);
-    if (it != m_uniformLocations.end()) {
-        return it->second;
+void Shader::queryUniforms()
+{
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    
+    std::string name(static_cast<size_t>(std::max(maxLength, 1)), '\0');
+    for (GLint i = 0; i < count; i++) 
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        glGetActiveUniform(m_id, static_cast<GLuint>(i), maxLength, &length, &size, &type, &name[0]);
+        
+        // Members of uniform blocks have no location and are set through the buffer
+        std::string uniformName(name.data(), static_cast<size_t>(length));
+        GLint location = glGetUniformLocation(m_id, uniformName.c_str());
+        if (location < 0) {
+            continue;
+        }
+        
+        // Arrays are listed as "name[0]"; both spellings find the first element
+        m_uniforms[uniformName] = UniformInfo{location, type};
+        size_t bracket = uniformName.find('[');
+        if (bracket != std::string::npos) {
+            m_uniforms[uniformName.substr(0, bracket)] = UniformInfo{location, type};
+        }
+    }
+}
+
+GLint Shader::findUniform(const std::string& name, bool (*matchesType)(GLenum))
+{
+    auto it = m_uniforms.find(name);
+    if (it == m_uniforms.end()) 
+    {
+        std::cerr << "Warning: Uniform '" << name << "' not found in shader program." << std::endl;
+        // Remembered so the warning is not repeated
+        m_uniforms[name] = UniformInfo{-1, GL_NONE};
+        return -1;
     }
     
-    GLint location = glGetUniformLocation(m_id, name.c_str());
-    m_uniformLocations[name] = location;
+    if (it->second.location >= 0 && matchesType && !matchesType(it->second.type)) {
+        std::cerr << "Warning: Uniform '" << name << "' has a different type in the shader program." << std::endl;
+        return -1;
+    }
     
-    if (location == -1) {
-        std::cerr << "Warning: Uniform '" << name << "' not found in shader program." << std::endl;
+    return it->second.location;
+}
+
+template <typename T>
+UniformHandle<T> Shader::getUniform(const std::string& name)
+{
+    UniformHandle<T> uniform;
+    uniform.location = findUniform(name, &UniformType<T>::matches);
+    return uniform;
+}
+
+template UniformInt Shader::getUniform<int>(const std::string& name);
+template UniformFloat Shader::getUniform<float>(const std::string& name);
+template UniformVec2 Shader::getUniform<glm::vec2>(const std::string& name);
+template UniformVec3 Shader::getUniform<glm::vec3>(const std::string& name);
+template UniformVec4 Shader::getUniform<glm::vec4>(const std::string& name);
+template UniformMat4 Shader::getUniform<glm::mat4>(const std::string& name);
+
+bool Shader::bindUniformBlock(const std::string& blockName, GLuint binding)
+{
+    GLuint index = glGetUniformBlockIndex(m_id, blockName.c_str());
+    if (index == GL_INVALID_INDEX) {
+        std::cerr << "Warning: Uniform block '" << blockName << "' not found in shader program." << std::endl;
+        return false;
     }
     
-    return location;
+    glUniformBlockBinding(m_id, index, binding);
+    return true;
+}
+
+GLint Shader::getUniformLocation(const std::string& name) {
+    return findUniform(name, nullptr);
 }
@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    shader_manager.cpp                                            //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "shader_manager.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kBinaryMagic[4] = {'P', 'S', 'H', 'B'};
+const uint32_t kBinaryVersion = 1;
+
+struct BinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t hash;
+    uint32_t format;
+    uint32_t length;
+};
+
+const struct {
+    unsigned feature;
+    const char* define;
+} kFeatureDefines[] = {
+    { kShaderGrayscale, "GRAYSCALE" },
+    { kShaderPremultipliedAlpha, "PREMULTIPLIED_ALPHA" },
+    { kShaderInstancing, "INSTANCING" },
+    { kShaderYCbCr, "YCBCR" },
+};
+
+uint64_t fnv1a64(const std::string& text, uint64_t hash = 14695981039346656037ull)
+{
+    // The terminator keeps ("ab", "c") and ("a", "bc") apart
+    for (size_t i = 0; i <= text.size(); i++) {
+        hash ^= static_cast<unsigned char>(text.c_str()[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string glString(GLenum name)
+{
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+// #version has to stay the first line; #line keeps error messages pointing at the file
+std::string withDefines(const std::string& source, const std::string& defines)
+{
+    if (defines.empty()) {
+        return source;
+    }
+    if (source.compare(0, 8, "#version") != 0) {
+        return defines + "#line 1\n" + source;
+    }
+    size_t lineEnd = source.find('\n');
+    if (lineEnd == std::string::npos) {
+        return source + "\n" + defines;
+    }
+    return source.substr(0, lineEnd + 1) + defines + "#line 2\n" + source.substr(lineEnd + 1);
+}
+
+} // namespace
+
+ShaderManager::ShaderManager(const std::string& sourceDirectory)
+    : m_sourceDirectory(sourceDirectory)
+{
+}
+
+void ShaderManager::setCacheDirectory(const std::string& directory)
+{
+    m_cacheDirectory.clear();
+    if (directory.empty() || !Shader::isBinarySupported()) {
+        return;
+    }
+
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Failed to create shader cache directory: " << directory << std::endl;
+        return;
+    }
+
+    m_cacheDirectory = directory;
+    m_driver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+}
+
+std::string ShaderManager::getDefines(unsigned features)
+{
+    std::string defines;
+    for (const auto& entry : kFeatureDefines) {
+        if (features & entry.feature) {
+            defines += "#define ";
+            defines += entry.define;
+            defines += " 1\n";
+        }
+    }
+    return defines;
+}
+
+Shader* ShaderManager::get(const std::string& name, unsigned features)
+{
+    std::string key = name + "#" + std::to_string(features);
+    auto it = m_programs.find(key);
+    if (it != m_programs.end()) {
+        return it->second.get();
+    }
+
+    std::unique_ptr<Shader>& program = m_programs[key];
+    std::string vertexSource, fragmentSource;
+    if (!readSource(m_sourceDirectory + "/" + name + ".vert", vertexSource) ||
+        !readSource(m_sourceDirectory + "/" + name + ".frag", fragmentSource)) {
+        return nullptr;
+    }
+
+    std::string defines = getDefines(features);
+    vertexSource = withDefines(vertexSource, defines);
+    fragmentSource = withDefines(fragmentSource, defines);
+
+    auto shader = std::make_unique<Shader>();
+    std::string cachePath;
+    uint64_t hash = 0;
+    if (!m_cacheDirectory.empty())
+    {
+        hash = fnv1a64(m_driver, fnv1a64(fragmentSource, fnv1a64(vertexSource)));
+        cachePath = m_cacheDirectory + "/" + name + "-" + std::to_string(features) + ".bin";
+        if (loadBinary(*shader, cachePath, hash)) {
+            m_stats.loadedFromCache++;
+            program = std::move(shader);
+            return program.get();
+        }
+    }
+
+    if (!shader->loadFromSource(vertexSource, fragmentSource)) {
+        std::cerr << "Failed to build shader " << name << " (" << features << ")" << std::endl;
+        return nullptr;
+    }
+    m_stats.compiled++;
+
+    if (!cachePath.empty()) {
+        storeBinary(*shader, cachePath, hash);
+    }
+    program = std::move(shader);
+    return program.get();
+}
+
+bool ShaderManager::readSource(const std::string& path, std::string& source)
+{
+    auto it = m_sources.find(path);
+    if (it != m_sources.end()) {
+        source = it->second;
+        return true;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to read shader " << path << std::endl;
+        return false;
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    source = stream.str();
+    m_sources[path] = source;
+    return true;
+}
+
+bool ShaderManager::loadBinary(Shader& shader, const std::string& path, uint64_t hash)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    BinaryHeader header;
+    std::vector<unsigned char> data;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) == 0 &&
+              header.version == kBinaryVersion && header.hash == hash && header.length > 0;
+    if (ok) {
+        data.resize(header.length);
+        ok = std::fread(data.data(), 1, data.size(), file) == data.size();
+    }
+    std::fclose(file);
+
+    // A stale or rejected binary is rebuilt from source and overwritten
+    return ok && shader.loadFromBinary(header.format, data.data(), static_cast<GLsizei>(data.size()));
+}
+
+void ShaderManager::storeBinary(const Shader& shader, const std::string& path, uint64_t hash)
+{
+    GLenum format = 0;
+    std::vector<unsigned char> data;
+    if (!shader.getBinary(format, data)) {
+        return;
+    }
+
+    BinaryHeader header;
+    std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+    header.version = kBinaryVersion;
+    header.hash = hash;
+    header.format = format;
+    header.length = static_cast<uint32_t>(data.size());
+
+    // Written aside and renamed, so a second instance never reads half a file
+    std::string temporary = path + ".tmp" + std::to_string(static_cast<long>(::getpid()));
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = (std::fclose(file) == 0) && ok;
+
+    std::error_code error;
+    if (ok) {
+        fs::rename(temporary, path, error);
+    }
+    if (!ok || error) {
+        fs::remove(temporary, error);
+    }
+}
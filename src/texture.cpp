@@ -7,14 +7,19 @@
 /////////////////////////////////////////////////////////////////////////
 
 #include "texture.h"
+#include "image_decoder.h"
+#include "pixel_pool.h"
 #include <iostream>
 
+// Decoded images come out of the pixel pool, so DecodedImage can adopt them
+#define STBI_MALLOC(size) PixelPool::allocate(size)
+#define STBI_REALLOC(block, size) PixelPool::reallocate(block, size)
+#define STBI_FREE(block) PixelPool::release(block)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
-#define STB_IMAGE_RESIZE_IMPLEMENTATION
-#include <stb/stb_image_resize.h>
 
-Texture::Texture() : m_id(0), m_width(0), m_height(0), m_channels(0) {
+Texture::Texture()
+    : m_id(0), m_width(0), m_height(0), m_channels(0), m_compressedFormat(BlockFormat::None), m_compressedBytes(0) {
 }
 
 Texture::~Texture() {
@@ -25,15 +30,27 @@ Texture::~Texture() {
 
 bool Texture::loadFromFile(const std::string& path) 
 {
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path.c_str(), &m_width, &m_height, &m_channels, 0);
+    DecodedImage image;
+    if (!ImageDecoder::decodeFile(path, image)) {
+        std::cerr << "Failed to load texture: " << path << std::endl;
+        return false;
+    }
     
+    return loadFromMemory(image.pixels.data(), image.width, image.height, image.channels);
+}
+
+bool Texture::loadFromMemory(const unsigned char* data, int width, int height, int channels) 
+{
     if (!data) {
-        std::cerr << "Failed to load texture: " << path << std::endl;
-        std::cerr << "Reason: " << stbi_failure_reason() << std::endl;
+        std::cerr << "Failed to load texture from memory: null data pointer" << std::endl;
         return false;
     }
     
+    m_width = width;
+    m_height = height;
+    m_channels = channels;
+    m_compressedFormat = BlockFormat::None;
+    
     generateTexture();
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -41,79 +58,93 @@ bool Texture::loadFromFile(const std::string& path)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
+    // Rows are tightly packed (RGB thumbnails are rarely 4-byte aligned)
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexImage2D(GL_TEXTURE_2D, 0, getInternalFormat(), m_width, m_height, 0, getFormat(), GL_UNSIGNED_BYTE, data);
     glGenerateMipmap(GL_TEXTURE_2D);
     
-    stbi_image_free(data);
-    
     return true;
 }
 
-bool Texture::loadFromMemory(const unsigned char* data, int width, int height, int channels) 
+bool Texture::loadCompressed(const unsigned char* blocks, size_t bytes, int width, int height, int channels, BlockFormat format) 
 {
-    if (!data) {
-        std::cerr << "Failed to load texture from memory: null data pointer" << std::endl;
+    if (!blocks || format == BlockFormat::None || bytes != BlockCompressor::compressedSize(format, width, height)) {
+        std::cerr << "Failed to load compressed texture: bad block data" << std::endl;
         return false;
     }
     
     m_width = width;
     m_height = height;
     m_channels = channels;
+    m_compressedFormat = format;
+    m_compressedBytes = bytes;
     
     generateTexture();
     
+    // Thumbnails and previews are drawn near their own size, one level is enough
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
     
-    glTexImage2D(GL_TEXTURE_2D, 0, getInternalFormat(), m_width, m_height, 0, getFormat(), GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    while (glGetError() != GL_NO_ERROR) {
+    }
+    
+    glCompressedTexImage2D(GL_TEXTURE_2D, 0, getCompressedInternalFormat(format), width, height, 0,
+                           static_cast<GLsizei>(bytes), blocks);
+    
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "Failed to upload " << BlockCompressor::getFormatName(format) << " texture" << std::endl;
+        return false;
+    }
     
     return true;
 }
 
-void Texture::bind(unsigned int slot) 
+bool Texture::loadCompressed(const CompressedImage& image, int channels) 
 {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, m_id);
+    return loadCompressed(image.blocks.data(), image.blocks.size(), image.width, image.height, channels, image.format);
 }
 
-std::unique_ptr<Texture> Texture::createThumbnail(int size) 
+bool Texture::allocate(int width, int height, int channels) 
 {
-    if (m_id == 0) {
-        return nullptr;
-    }
-    
-    int thumbWidth, thumbHeight;
-    if (m_width > m_height) 
-    {
-        thumbWidth = size;
-        thumbHeight = static_cast<int>(size * (static_cast<float>(m_height) / m_width));
-    } 
-    else 
-    {
-        thumbHeight = size;
-        thumbWidth = static_cast<int>(size * (static_cast<float>(m_width) / m_height));
+    if (width <= 0 || height <= 0) {
+        return false;
     }
     
-    unsigned char* resizedData = new unsigned char[thumbWidth * thumbHeight * m_channels];
-    
-    glBindTexture(GL_TEXTURE_2D, m_id);
+    m_width = width;
+    m_height = height;
+    m_channels = channels;
+    m_compressedFormat = BlockFormat::None;
     
-    unsigned char* originalData = new unsigned char[m_width * m_height * m_channels];
-    glGetTexImage(GL_TEXTURE_2D, 0, getFormat(), GL_UNSIGNED_BYTE, originalData);
+    generateTexture();
     
-    stbir_resize_uint8(originalData, m_width, m_height, 0,
-                      resizedData, thumbWidth, thumbHeight, 0, m_channels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
-    auto thumbnail = std::make_unique<Texture>();
-    thumbnail->loadFromMemory(resizedData, thumbWidth, thumbHeight, m_channels);
+    glTexImage2D(GL_TEXTURE_2D, 0, getInternalFormat(), m_width, m_height, 0, getFormat(), GL_UNSIGNED_BYTE, nullptr);
     
-    delete[] originalData;
-    delete[] resizedData;
+    return true;
+}
+
+void Texture::bind(unsigned int slot) 
+{
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, m_id);
+}
+
+size_t Texture::getByteSize() const 
+{
+    if (m_compressedFormat != BlockFormat::None) {
+        return m_compressedBytes;
+    }
     
-    return thumbnail;
+    // Drivers pad RGB to four bytes a texel; the mip chain adds about a third
+    size_t base = static_cast<size_t>(m_width) * m_height * (m_channels == 1 ? 1 : 4);
+    return base + base / 3;
 }
 
 void Texture::generateTexture() 
@@ -143,3 +174,21 @@ GLenum Texture::getFormat() const {
         default: return GL_RGB;
     }
 }
+
+GLenum Texture::getCompressedInternalFormat(BlockFormat format) {
+    switch (format) {
+        case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case BlockFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+        default: return GL_RGBA8;
+    }
+}
+
+bool Texture::isCompressionSupported(TextureCompression compression) {
+    switch (compression) {
+        case TextureCompression::None: return true;
+        case TextureCompression::S3tc: return GLEW_EXT_texture_compression_s3tc;
+        case TextureCompression::Bptc: return GLEW_ARB_texture_compression_bptc;
+    }
+    return false;
+}
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    texture_cache.cpp                                             //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "texture_cache.h"
+#include "texture.h"
+
+TextureCache::TextureCache(size_t budgetBytes) 
+{
+    m_stats.budgetBytes = budgetBytes;
+}
+
+TextureCache::~TextureCache() 
+{
+    clear();
+}
+
+std::shared_ptr<Texture> TextureCache::find(const std::string& path) 
+{
+    auto it = m_lookup.find(path);
+    if (it == m_lookup.end()) {
+        m_stats.misses++;
+        return nullptr;
+    }
+    
+    m_stats.hits++;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->texture;
+}
+
+void TextureCache::insert(const std::string& path, std::shared_ptr<Texture> texture) 
+{
+    if (!texture) {
+        return;
+    }
+    
+    erase(path);
+    
+    size_t bytes = texture->getByteSize();
+    m_entries.push_front({ path, std::move(texture), bytes });
+    m_lookup[path] = m_entries.begin();
+    
+    m_stats.residentBytes += bytes;
+    m_stats.entries = m_entries.size();
+    
+    evictToBudget();
+}
+
+void TextureCache::erase(const std::string& path) 
+{
+    auto it = m_lookup.find(path);
+    if (it == m_lookup.end()) {
+        return;
+    }
+    
+    m_stats.residentBytes -= it->second->bytes;
+    m_entries.erase(it->second);
+    m_lookup.erase(it);
+    m_stats.entries = m_entries.size();
+}
+
+void TextureCache::clear() 
+{
+    m_entries.clear();
+    m_lookup.clear();
+    m_stats.residentBytes = 0;
+    m_stats.entries = 0;
+}
+
+void TextureCache::setBudget(size_t budgetBytes) 
+{
+    m_stats.budgetBytes = budgetBytes;
+    evictToBudget();
+}
+
+void TextureCache::evictToBudget() 
+{
+    while (!m_entries.empty() && m_stats.residentBytes > m_stats.budgetBytes) 
+    {
+        const Entry& victim = m_entries.back();
+        m_stats.residentBytes -= victim.bytes;
+        m_lookup.erase(victim.path);
+        m_entries.pop_back();
+        m_stats.evictions++;
+    }
+    
+    m_stats.entries = m_entries.size();
+}
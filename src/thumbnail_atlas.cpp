@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    thumbnail_atlas.cpp                                           //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "thumbnail_atlas.h"
+#include "upload_stream.h"
+#include "texture.h"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+
+// Grey has no core format that lands in all three channels, so it is widened to RGB
+void copyPixels(const unsigned char* source, size_t pixelCount, int channels, unsigned char* target)
+{
+    if (channels == 3 || channels == 4) {
+        std::copy(source, source + pixelCount * channels, target);
+        return;
+    }
+    
+    for (size_t i = 0; i < pixelCount; i++) {
+        unsigned char grey = source[i * channels];
+        target[i * 3 + 0] = grey;
+        target[i * 3 + 1] = grey;
+        target[i * 3 + 2] = grey;
+    }
+}
+
+} // namespace
+
+ThumbnailAtlas::ThumbnailAtlas() : m_layerSize(0), m_layersPerPage(0), m_uploadStream(nullptr) {
+}
+
+ThumbnailAtlas::~ThumbnailAtlas() {
+    for (auto& page : m_pages) {
+        glDeleteTextures(1, &page.texture);
+    }
+}
+
+bool ThumbnailAtlas::initialize(int layerSize, int layersPerPage, TextureCompression compression) 
+{
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    
+    m_layerSize = (layerSize + 3) & ~3;
+    m_layersPerPage = std::max(1, std::min(layersPerPage, static_cast<int>(maxLayers)));
+    
+    // Opaque photos are the common case, other formats get pages on demand
+    return addPage(BlockCompressor::formatFor(compression, 3));
+}
+
+bool ThumbnailAtlas::upload(const unsigned char* pixels, int width, int height, int channels, Slot& slot) 
+{
+    if (!pixels || width <= 0 || height <= 0 || width > m_layerSize || height > m_layerSize) {
+        std::cerr << "Thumbnail does not fit the atlas: " << width << "x" << height << std::endl;
+        return false;
+    }
+    
+    if (!acquireLayer(BlockFormat::None, slot)) {
+        return false;
+    }
+    
+    slot.width = width;
+    slot.height = height;
+    
+    GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    size_t bytes = pixelCount * ((channels == 4) ? 4 : 3);
+    
+    // Written straight into this frame's upload section when it has room
+    size_t offset = 0;
+    unsigned char* staged = m_uploadStream ? m_uploadStream->allocate(bytes, offset) : nullptr;
+    if (staged) {
+        copyPixels(pixels, pixelCount, channels, staged);
+        m_uploadStream->copyToTextureLayer(m_pages[slot.page].texture, slot.layer, width, height, format, offset);
+        return true;
+    }
+    
+    if (channels != 3 && channels != 4) {
+        m_expandBuffer.resize(bytes);
+        copyPixels(pixels, pixelCount, channels, m_expandBuffer.data());
+        pixels = m_expandBuffer.data();
+    }
+    
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_pages[slot.page].texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, slot.layer, width, height, 1, format, GL_UNSIGNED_BYTE, pixels);
+    
+    return true;
+}
+
+bool ThumbnailAtlas::uploadCompressed(const unsigned char* blocks, size_t bytes, int width, int height,
+                                      BlockFormat format, Slot& slot) 
+{
+    if (!blocks || format == BlockFormat::None || width <= 0 || height <= 0 ||
+        width > m_layerSize || height > m_layerSize || bytes != BlockCompressor::compressedSize(format, width, height)) {
+        std::cerr << "Compressed thumbnail does not fit the atlas: " << width << "x" << height << std::endl;
+        return false;
+    }
+    
+    if (!acquireLayer(format, slot)) {
+        return false;
+    }
+    
+    slot.width = width;
+    slot.height = height;
+    
+    // Sub-image updates must cover whole blocks; the layer size is a multiple of four
+    int blockWidth = (width + 3) & ~3;
+    int blockHeight = (height + 3) & ~3;
+    GLenum internalFormat = Texture::getCompressedInternalFormat(format);
+    
+    size_t offset = 0;
+    unsigned char* staged = m_uploadStream ? m_uploadStream->allocate(bytes, offset) : nullptr;
+    if (staged) {
+        std::copy(blocks, blocks + bytes, staged);
+        m_uploadStream->copyCompressedToTextureLayer(m_pages[slot.page].texture, slot.layer, blockWidth, blockHeight,
+                                                     internalFormat, bytes, offset);
+        return true;
+    }
+    
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_pages[slot.page].texture);
+    glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, slot.layer, blockWidth, blockHeight, 1,
+                              internalFormat, static_cast<GLsizei>(bytes), blocks);
+    
+    return true;
+}
+
+void ThumbnailAtlas::release(Slot& slot) 
+{
+    if (slot.isValid() && slot.page < static_cast<int>(m_pages.size())) {
+        m_pages[slot.page].freeLayers.push_back(slot.layer);
+    }
+    
+    slot = Slot();
+}
+
+void ThumbnailAtlas::clear() 
+{
+    for (auto& page : m_pages) {
+        page.freeLayers.clear();
+        for (int layer = m_layersPerPage - 1; layer >= 0; layer--) {
+            page.freeLayers.push_back(layer);
+        }
+    }
+}
+
+void ThumbnailAtlas::getUvRect(const Slot& slot, float uv[4]) const 
+{
+    float texel = 1.0f / m_layerSize;
+    uv[0] = 0.5f * texel;
+    uv[1] = 0.5f * texel;
+    uv[2] = (slot.width - 0.5f) * texel;
+    uv[3] = (slot.height - 0.5f) * texel;
+}
+
+bool ThumbnailAtlas::acquireLayer(BlockFormat format, Slot& slot) 
+{
+    // A slot only keeps its layer while the format stays the same
+    if (slot.isValid() && m_pages[slot.page].format == format) {
+        return true;
+    }
+    release(slot);
+    
+    int page = -1;
+    for (size_t i = 0; i < m_pages.size(); i++) {
+        if (m_pages[i].format == format && !m_pages[i].freeLayers.empty()) {
+            page = static_cast<int>(i);
+            break;
+        }
+    }
+    
+    if (page < 0) {
+        if (!addPage(format)) {
+            return false;
+        }
+        page = static_cast<int>(m_pages.size()) - 1;
+    }
+    
+    slot.page = page;
+    slot.layer = m_pages[page].freeLayers.back();
+    m_pages[page].freeLayers.pop_back();
+    return true;
+}
+
+bool ThumbnailAtlas::addPage(BlockFormat format) 
+{
+    Page page;
+    page.format = format;
+    glGenTextures(1, &page.texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+    
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    
+    while (glGetError() != GL_NO_ERROR) {
+    }
+    
+    GLenum internalFormat = (format == BlockFormat::None) ? GL_RGBA8 : Texture::getCompressedInternalFormat(format);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, m_layerSize, m_layerSize, m_layersPerPage, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "Failed to allocate " << BlockCompressor::getFormatName(format) << " thumbnail atlas page" << std::endl;
+        glDeleteTextures(1, &page.texture);
+        return false;
+    }
+    
+    for (int layer = m_layersPerPage - 1; layer >= 0; layer--) {
+        page.freeLayers.push_back(layer);
+    }
+    
+    m_pages.push_back(std::move(page));
+    return true;
+}
@@ -0,0 +1,620 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    thumbnail_cache.cpp                                           //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "thumbnail_cache.h"
+
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kPackMagic[8] = { 'P', 'I', 'C', 'T', 'H', 'M', 'B', '1' };
+const uint32_t kPackVersion = 4;            // 2: EXIF orientation applied, 3: block compressed records, 4: payload checksummed
+const uint32_t kRecordMagic = 0x43455254;   // "TREC"
+const uint32_t kTrailerMagic = 0x444E4554;  // "TEND"
+const uint64_t kCompactMinDeadBytes = 4 * 1024 * 1024;
+
+struct PackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+// Record layout: header | path | pad | pixels or blocks | pad | trailer
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t recordSize;
+    uint64_t fileSize;
+    int64_t mtimeNs;
+    uint64_t contentHash;
+    uint32_t pixelBytes;
+    uint16_t pathLength;
+    uint16_t thumbnailSize;
+    uint16_t width;
+    uint16_t height;
+    uint8_t channels;
+    uint8_t flags;
+    uint8_t format;         // BlockFormat
+    uint8_t reserved;
+    uint32_t checksum;
+    uint32_t padding;
+};
+
+struct RecordTrailer {
+    uint32_t magic;
+    uint32_t checksum;
+};
+
+static_assert(sizeof(PackHeader) == 16, "unexpected pack header size");
+static_assert(sizeof(RecordHeader) == 56, "unexpected record header size");
+static_assert(sizeof(RecordTrailer) == 8, "unexpected record trailer size");
+
+uint32_t align8(uint32_t value)
+{
+    return (value + 7u) & ~7u;
+}
+
+uint32_t pixelsOffset(const RecordHeader& header)
+{
+    return align8(sizeof(RecordHeader) + header.pathLength);
+}
+
+uint32_t expectedPixelBytes(const RecordHeader& header)
+{
+    BlockFormat format = static_cast<BlockFormat>(header.format);
+    if (format == BlockFormat::None) {
+        return static_cast<uint32_t>(header.width) * header.height * header.channels;
+    }
+    return static_cast<uint32_t>(BlockCompressor::compressedSize(format, header.width, header.height));
+}
+
+uint32_t fnv1a32(const void* data, size_t size, uint32_t hash = 2166136261u)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// FNV-1a over 8 byte words, fast enough to check every payload on open
+uint64_t hashWords(const unsigned char* data, size_t size, uint64_t hash)
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    for (; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Covers the payload too: a torn append can reach disk with the header and
+// trailer pages but not the pixels in between
+uint32_t recordChecksum(RecordHeader header, const char* path, const unsigned char* pixels)
+{
+    header.checksum = 0;
+    uint32_t hash = fnv1a32(&header, sizeof(header));
+    hash = fnv1a32(path, header.pathLength, hash);
+    uint64_t payload = hashWords(pixels, header.pixelBytes, 14695981039346656037ull);
+    return fnv1a32(&payload, sizeof(payload), hash);
+}
+
+bool statFile(const std::string& path, uint64_t& size, int64_t& mtimeNs)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+
+    size = static_cast<uint64_t>(st.st_size);
+    mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+uint64_t hashFile(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+    unsigned char buffer[64 * 1024];
+    ssize_t count;
+    while ((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t i = 0; i < count; i++) {
+            hash ^= buffer[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    ::close(fd);
+    return count < 0 ? 0 : hash;
+}
+
+bool writeAll(int fd, const void* data, size_t size, uint64_t offset)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+}
+
+} // namespace
+
+ThumbnailCache::ThumbnailCache()
+    : m_fd(-1),
+      m_lockFd(-1),
+      m_readOnly(false),
+      m_map(nullptr),
+      m_mapSize(0),
+      m_fileSize(0),
+      m_liveBytes(0),
+      m_deadBytes(0),
+      m_hashContents(false)
+{
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    close();
+}
+
+std::string ThumbnailCache::defaultDirectory()
+{
+    const char* xdgCache = std::getenv("XDG_CACHE_HOME");
+    if (xdgCache && *xdgCache) {
+        return std::string(xdgCache) + "/opengl_picasa";
+    }
+
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        return std::string(home) + "/.cache/opengl_picasa";
+    }
+
+    return ".picasa_cache";
+}
+
+bool ThumbnailCache::open(const std::string& directory)
+{
+    close();
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Failed to create thumbnail cache directory: " << directory << std::endl;
+        return false;
+    }
+
+    m_packPath = directory + "/thumbnails.pack";
+    m_lockPath = directory + "/thumbnails.lock";
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!lockPack()) {
+        std::cerr << "Thumbnail cache is in use by another process, opening it read-only" << std::endl;
+    }
+
+    if (!openPack() || !mapPack()) {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+        unlockPack();
+        return false;
+    }
+
+    scanRecords();
+
+    if (!m_readOnly && m_deadBytes > m_liveBytes && m_deadBytes >= kCompactMinDeadBytes) {
+        compact();
+    }
+
+    return m_fd >= 0;
+}
+
+void ThumbnailCache::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_fd < 0) {
+        return;
+    }
+
+    if (!m_readOnly && m_deadBytes > m_liveBytes && m_deadBytes >= kCompactMinDeadBytes) {
+        compact();
+    }
+
+    if (m_fd >= 0) {
+        if (!m_readOnly) {
+            ::fdatasync(m_fd);
+        }
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    unmapPack();
+    unlockPack();
+    m_index.clear();
+    m_fileSize = 0;
+    m_liveBytes = 0;
+    m_deadBytes = 0;
+}
+
+bool ThumbnailCache::lookup(const std::string& path, int thumbnailSize, Entry& entry)
+{
+    IndexEntry indexEntry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(path);
+        if (it == m_index.end()) {
+            return false;
+        }
+        indexEntry = it->second;
+    }
+
+    // The mapping is immutable while open, so validation runs unlocked
+    const unsigned char* record = m_map + indexEntry.offset;
+    if (!isRecordCurrent(record, path, thumbnailSize)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(path);
+        if (it != m_index.end() && it->second.offset == indexEntry.offset) {
+            m_deadBytes += indexEntry.size;
+            m_liveBytes -= indexEntry.size;
+            m_index.erase(it);
+        }
+        return false;
+    }
+
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+
+    entry.pixels = record + pixelsOffset(header);
+    entry.width = header.width;
+    entry.height = header.height;
+    entry.channels = header.channels;
+    entry.format = static_cast<BlockFormat>(header.format);
+    entry.byteSize = header.pixelBytes;
+    return true;
+}
+
+bool ThumbnailCache::store(const std::string& path, int thumbnailSize,
+                           const unsigned char* pixels, int width, int height, int channels,
+                           BlockFormat format)
+{
+    if (m_fd < 0 || m_readOnly || !pixels || path.size() > 0xFFFF ||
+        width <= 0 || height <= 0 || width > 0xFFFF || height > 0xFFFF ||
+        channels < 1 || channels > 4 || thumbnailSize <= 0 || thumbnailSize > 0xFFFF) {
+        return false;
+    }
+
+    RecordHeader header = {};
+    if (!statFile(path, header.fileSize, header.mtimeNs)) {
+        return false;
+    }
+
+    header.magic = kRecordMagic;
+    header.contentHash = m_hashContents ? hashFile(path) : 0;
+    header.pathLength = static_cast<uint16_t>(path.size());
+    header.thumbnailSize = static_cast<uint16_t>(thumbnailSize);
+    header.width = static_cast<uint16_t>(width);
+    header.height = static_cast<uint16_t>(height);
+    header.channels = static_cast<uint8_t>(channels);
+    header.format = static_cast<uint8_t>(format);
+    header.pixelBytes = expectedPixelBytes(header);
+
+    uint32_t trailerOffset = align8(pixelsOffset(header) + header.pixelBytes);
+    header.recordSize = trailerOffset + sizeof(RecordTrailer);
+    header.checksum = recordChecksum(header, path.data(), pixels);
+
+    RecordTrailer trailer = { kTrailerMagic, header.checksum };
+
+    std::vector<unsigned char> record(header.recordSize, 0);
+    std::memcpy(record.data(), &header, sizeof(header));
+    std::memcpy(record.data() + sizeof(header), path.data(), path.size());
+    std::memcpy(record.data() + pixelsOffset(header), pixels, header.pixelBytes);
+    std::memcpy(record.data() + trailerOffset, &trailer, sizeof(trailer));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_fd < 0) {
+        return false;
+    }
+
+    if (!writeAll(m_fd, record.data(), record.size(), m_fileSize)) {
+        std::cerr << "Failed to write thumbnail cache record: " << m_packPath << std::endl;
+        if (::ftruncate(m_fd, static_cast<off_t>(m_fileSize)) != 0) {
+            std::cerr << "Failed to roll back thumbnail cache record" << std::endl;
+        }
+        return false;
+    }
+
+    m_fileSize += record.size();
+    m_liveBytes += record.size();
+
+    // Records appended this session become visible on the next open
+    auto it = m_index.find(path);
+    if (it != m_index.end()) {
+        m_deadBytes += it->second.size;
+        m_liveBytes -= it->second.size;
+        m_index.erase(it);
+    }
+
+    return true;
+}
+
+// The lock file is never renamed, so the lock survives compaction
+bool ThumbnailCache::lockPack()
+{
+    m_lockFd = ::open(m_lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    m_readOnly = m_lockFd < 0 || ::flock(m_lockFd, LOCK_EX | LOCK_NB) != 0;
+    return !m_readOnly;
+}
+
+void ThumbnailCache::unlockPack()
+{
+    if (m_lockFd >= 0) {
+        ::close(m_lockFd);
+        m_lockFd = -1;
+    }
+    m_readOnly = false;
+}
+
+bool ThumbnailCache::openPack()
+{
+    m_fd = ::open(m_packPath.c_str(), (m_readOnly ? O_RDONLY : (O_RDWR | O_CREAT)) | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        std::cerr << "Failed to open thumbnail cache: " << m_packPath << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0) {
+        return false;
+    }
+    m_fileSize = static_cast<uint64_t>(st.st_size);
+
+    PackHeader header = {};
+    bool valid = m_fileSize >= sizeof(header) &&
+                 ::pread(m_fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                 std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) == 0 &&
+                 header.version == kPackVersion;
+
+    // Only the owner may start a new pack
+    if (!valid && m_readOnly) {
+        return false;
+    }
+    if (!valid) {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+        header.version = kPackVersion;
+
+        if (::ftruncate(m_fd, 0) != 0 || !writeAll(m_fd, &header, sizeof(header), 0)) {
+            std::cerr << "Failed to initialize thumbnail cache: " << m_packPath << std::endl;
+            return false;
+        }
+        m_fileSize = sizeof(header);
+    }
+
+    return true;
+}
+
+bool ThumbnailCache::mapPack()
+{
+    m_mapSize = static_cast<size_t>(m_fileSize);
+    void* map = ::mmap(nullptr, m_mapSize, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        std::cerr << "Failed to map thumbnail cache: " << m_packPath << std::endl;
+        m_map = nullptr;
+        m_mapSize = 0;
+        return false;
+    }
+
+    m_map = static_cast<unsigned char*>(map);
+    ::madvise(m_map, m_mapSize, MADV_WILLNEED);
+    return true;
+}
+
+void ThumbnailCache::unmapPack()
+{
+    if (m_map) {
+        ::munmap(m_map, m_mapSize);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
+}
+
+void ThumbnailCache::scanRecords()
+{
+    m_index.clear();
+    m_liveBytes = 0;
+    m_deadBytes = 0;
+
+    uint64_t offset = sizeof(PackHeader);
+    while (offset + sizeof(RecordHeader) + sizeof(RecordTrailer) <= m_mapSize)
+    {
+        RecordHeader header;
+        std::memcpy(&header, m_map + offset, sizeof(header));
+
+        if (header.magic != kRecordMagic || header.recordSize % 8 != 0 ||
+            header.recordSize > m_mapSize - offset) {
+            break;
+        }
+
+        uint32_t trailerOffset = align8(pixelsOffset(header) + header.pixelBytes);
+        if (trailerOffset + sizeof(RecordTrailer) != header.recordSize ||
+            header.format > static_cast<uint8_t>(BlockFormat::BC7) ||
+            header.pixelBytes != expectedPixelBytes(header)) {
+            break;
+        }
+
+        const char* path = reinterpret_cast<const char*>(m_map + offset + sizeof(header));
+        if (recordChecksum(header, path, m_map + offset + pixelsOffset(header)) != header.checksum) {
+            break;
+        }
+
+        RecordTrailer trailer;
+        std::memcpy(&trailer, m_map + offset + trailerOffset, sizeof(trailer));
+        if (trailer.magic != kTrailerMagic || trailer.checksum != header.checksum) {
+            break;
+        }
+
+        IndexEntry& entry = m_index[std::string(path, header.pathLength)];
+        if (entry.size != 0) {
+            m_deadBytes += entry.size;
+            m_liveBytes -= entry.size;
+        }
+        entry.offset = offset;
+        entry.size = header.recordSize;
+        m_liveBytes += header.recordSize;
+
+        offset += header.recordSize;
+    }
+
+    // Anything after the last complete record is a torn write, unless the
+    // owner is still appending it
+    if (offset < m_fileSize && !m_readOnly) {
+        std::cerr << "Thumbnail cache: dropping " << (m_fileSize - offset)
+                  << " bytes of incomplete records" << std::endl;
+        if (::ftruncate(m_fd, static_cast<off_t>(offset)) == 0) {
+            m_fileSize = offset;
+        }
+    }
+}
+
+bool ThumbnailCache::compact()
+{
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0) {
+        return false;
+    }
+
+    unmapPack();
+    m_fileSize = static_cast<uint64_t>(st.st_size);
+    if (!mapPack()) {
+        m_index.clear();
+        return false;
+    }
+    scanRecords();
+
+    std::vector<std::pair<std::string, IndexEntry>> records(m_index.begin(), m_index.end());
+    std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+        return a.second.offset < b.second.offset;
+    });
+
+    std::string tmpPath = m_packPath + ".tmp";
+    int out = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        std::cerr << "Failed to compact thumbnail cache: " << tmpPath << std::endl;
+        return false;
+    }
+
+    PackHeader packHeader = {};
+    std::memcpy(packHeader.magic, kPackMagic, sizeof(kPackMagic));
+    packHeader.version = kPackVersion;
+
+    bool ok = writeAll(out, &packHeader, sizeof(packHeader), 0);
+    uint64_t outSize = sizeof(packHeader);
+
+    for (const auto& record : records)
+    {
+        if (!ok) {
+            break;
+        }
+
+        const unsigned char* data = m_map + record.second.offset;
+        RecordHeader header;
+        std::memcpy(&header, data, sizeof(header));
+
+        if (!isRecordCurrent(data, record.first, header.thumbnailSize)) {
+            continue;
+        }
+
+        ok = writeAll(out, data, record.second.size, outSize);
+        outSize += record.second.size;
+    }
+
+    ok = ok && ::fsync(out) == 0;
+    ::close(out);
+
+    if (!ok || ::rename(tmpPath.c_str(), m_packPath.c_str()) != 0) {
+        std::cerr << "Failed to compact thumbnail cache: " << m_packPath << std::endl;
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+
+    int dirFd = ::open(fs::path(m_packPath).parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+
+    unmapPack();
+    ::close(m_fd);
+    m_fd = -1;
+
+    if (!openPack() || !mapPack()) {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+        m_index.clear();
+        return false;
+    }
+
+    scanRecords();
+    return true;
+}
+
+bool ThumbnailCache::isRecordCurrent(const unsigned char* record, const std::string& path, int thumbnailSize)
+{
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+
+    if (header.thumbnailSize != thumbnailSize) {
+        return false;
+    }
+
+    uint64_t fileSize;
+    int64_t mtimeNs;
+    if (!statFile(path, fileSize, mtimeNs) || fileSize != header.fileSize || mtimeNs != header.mtimeNs) {
+        return false;
+    }
+
+    if (m_hashContents && header.contentHash != 0 && hashFile(path) != header.contentHash) {
+        return false;
+    }
+
+    return true;
+}
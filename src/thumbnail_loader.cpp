@@ -0,0 +1,228 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    thumbnail_loader.cpp                                          //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "thumbnail_loader.h"
+#include "profiler.h"
+
+#include <algorithm>
+
+ThumbnailLoader::ThumbnailLoader()
+    : m_stopping(false),
+      m_generation(0),
+      m_windowFirst(0),
+      m_windowLast(0),
+      m_activeJobs(0),
+      m_results(1024)
+{
+}
+
+ThumbnailLoader::~ThumbnailLoader()
+{
+    stop();
+}
+
+void ThumbnailLoader::start(unsigned threadCount)
+{
+    if (!m_threads.empty()) {
+        return;
+    }
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_stopping = false;
+    for (unsigned i = 0; i < threadCount; i++) {
+        m_threads.emplace_back(&ThumbnailLoader::workerLoop, this);
+    }
+
+    // Thumbnails served from the pack never read their source file
+    m_readAhead.setFilter([this](const std::string& path) {
+        std::shared_ptr<const Batch> batch;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            batch = m_batch;
+        }
+        ThumbnailCache::Entry entry;
+        return batch && !(batch->cache && batch->cache->lookup(path, batch->thumbnailSize, entry));
+    });
+    m_readAhead.start();
+}
+
+void ThumbnailLoader::stop()
+{
+    m_readAhead.stop();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_batch.reset();
+        m_jobs.clear();
+    }
+    m_generation++;
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+
+    ThumbnailResult result;
+    while (m_results.tryPop(result)) {
+    }
+}
+
+void ThumbnailLoader::setFiles(const std::vector<std::string>& paths, int thumbnailSize, ThumbnailCache* cache,
+                               TextureCompression compression)
+{
+    auto batch = std::make_shared<Batch>();
+    batch->paths = paths;
+    batch->thumbnailSize = thumbnailSize;
+    batch->cache = cache;
+    batch->compression = compression;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    batch->generation = ++m_generation;
+    m_batch = batch;
+    m_jobs.clear();
+    m_readAhead.clear();
+}
+
+void ThumbnailLoader::appendFiles(const std::vector<std::string>& paths)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_batch) {
+        return;
+    }
+
+    // Existing indices stay valid, so queued jobs and results in flight carry over
+    auto batch = std::make_shared<Batch>(*m_batch);
+    batch->paths.insert(batch->paths.end(), paths.begin(), paths.end());
+    m_batch = batch;
+}
+
+void ThumbnailLoader::setWindow(int first, int last)
+{
+    m_windowFirst = first;
+    m_windowLast = last;
+}
+
+void ThumbnailLoader::request(int index)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_batch) {
+            return;
+        }
+        m_jobs.push_back(index);
+        if (index >= 0 && index < static_cast<int>(m_batch->paths.size())) {
+            m_readAhead.enqueue(m_batch->paths[index]);
+        }
+    }
+    m_condition.notify_one();
+}
+
+void ThumbnailLoader::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_batch.reset();
+    m_jobs.clear();
+    m_generation++;
+    m_readAhead.clear();
+}
+
+bool ThumbnailLoader::poll(ThumbnailResult& result)
+{
+    while (m_results.tryPop(result)) {
+        if (result.generation == m_generation.load()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThumbnailLoader::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_jobs.empty() || m_activeJobs.load() > 0 || !m_results.empty();
+}
+
+void ThumbnailLoader::workerLoop()
+{
+    Profiler::setThreadName("thumbnail worker");
+
+    for (;;) 
+    {
+        std::shared_ptr<const Batch> batch;
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+            if (m_stopping) {
+                return;
+            }
+
+            index = m_jobs.front();
+            m_jobs.pop_front();
+            batch = m_batch;
+            m_activeJobs++;
+        }
+
+        if (batch) {
+            processJob(*batch, index);
+        }
+        m_activeJobs--;
+    }
+}
+
+void ThumbnailLoader::processJob(const Batch& batch, int index)
+{
+    if (index < 0 || index >= static_cast<int>(batch.paths.size())) {
+        return;
+    }
+
+    const std::string& path = batch.paths[index];
+    PROFILE_SCOPE_DETAIL("thumbnail", path);
+    m_readAhead.consume(path);
+
+    ThumbnailResult result;
+    result.index = index;
+    result.generation = batch.generation;
+
+    if (index < m_windowFirst.load() || index >= m_windowLast.load()) {
+        result.status = ThumbnailResult::Status::Skipped;
+    } else if (batch.cache && batch.cache->lookup(path, batch.thumbnailSize, result.cached) &&
+               result.cached.format == BlockCompressor::formatFor(batch.compression, result.cached.channels)) {
+        result.fromCache = true;
+    } else if (ImageDecoder::decodeThumbnail(path, batch.thumbnailSize, result.image)) {
+        const DecodedImage& image = result.image;
+        BlockFormat format = BlockCompressor::formatFor(batch.compression, image.channels);
+        if (format != BlockFormat::None) {
+            BlockCompressor::compress(image.pixels.data(), image.width, image.height, image.channels,
+                                      format, result.compressed);
+        }
+        if (batch.cache) {
+            PROFILE_SCOPE("cache store");
+            batch.cache->store(path, batch.thumbnailSize, result.pixels(),
+                               image.width, image.height, image.channels, result.format());
+        }
+    } else {
+        result.status = ThumbnailResult::Status::Failed;
+    }
+
+    // Back off while the GL thread drains the queue
+    while (!m_results.tryPush(std::move(result))) {
+        if (batch.generation != m_generation.load()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+    if (m_wake) {
+        m_wake();
+    }
+}
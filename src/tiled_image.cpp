@@ -0,0 +1,543 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    tiled_image.cpp                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "tiled_image.h"
+#include "shader.h"
+#include "image_decoder.h"
+#include "jpeg_decoder.h"
+#include "png_decoder.h"
+#include "profiler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <linux/magic.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+TiledImage::TiledImage()
+    : m_width(0),
+      m_height(0),
+      m_channels(0),
+      m_fd(-1),
+      m_map(nullptr),
+      m_mapSize(0),
+      m_tileBytes(0),
+      m_cancel(false),
+      m_complete(false),
+      m_maxResidentTiles(192),
+      m_maxUploadsPerFrame(4),
+      m_source(Source::Decoded)
+{
+}
+
+TiledImage::~TiledImage()
+{
+    close();
+}
+
+bool TiledImage::open(const std::string& path, int width, int height, const std::string& scratchDirectory)
+{
+    close();
+
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    // Tiles are RGB or RGBA; grey sources are expanded on the way in
+    int pngWidth, pngHeight;
+    bool hasAlpha = false, interlaced = false;
+    if (JpegDecoder::isJpegPath(path)) {
+        m_source = Source::Jpeg;
+        m_channels = 3;
+    } else if (PngDecoder::readHeader(path, pngWidth, pngHeight, hasAlpha, interlaced)) {
+        m_source = interlaced ? Source::Decoded : Source::Png;
+        m_channels = hasAlpha ? 4 : 3;
+    } else {
+        int infoWidth, infoHeight, channels;
+        if (!ImageDecoder::readInfo(path, infoWidth, infoHeight, channels)) {
+            return false;
+        }
+        m_source = Source::Decoded;
+        m_channels = (channels == 2 || channels == 4) ? 4 : 3;
+    }
+
+    m_path = path;
+    m_width = width;
+    m_height = height;
+    m_tileBytes = static_cast<size_t>(kTileSize) * kTileSize * m_channels;
+
+    uint64_t offset = 0;
+    int levelWidth = width, levelHeight = height;
+    for (;;)
+    {
+        Level level;
+        level.width = levelWidth;
+        level.height = levelHeight;
+        level.tilesX = (levelWidth + kTileSize - 1) / kTileSize;
+        level.tilesY = (levelHeight + kTileSize - 1) / kTileSize;
+        level.offset = offset;
+        m_levels.push_back(level);
+
+        offset += static_cast<uint64_t>(level.tilesX) * level.tilesY * m_tileBytes;
+        if (levelWidth <= kTileSize && levelHeight <= kTileSize) {
+            break;
+        }
+        levelWidth = std::max(1, (levelWidth + 1) / 2);
+        levelHeight = std::max(1, (levelHeight + 1) / 2);
+    }
+
+    // Unlinked scratch file: the pyramid lives in the page cache, dirty pages
+    // are written back by the periodic flush, and nothing is left on disk
+    std::error_code error;
+    fs::create_directories(scratchDirectory, error);
+    std::string pattern = scratchDirectory + "/tilesXXXXXX";
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+
+    m_fd = error ? -1 : mkstemp(name.data());
+    if (m_fd < 0) {
+        std::cerr << "Failed to create tile scratch file in " << scratchDirectory << std::endl;
+        close();
+        return false;
+    }
+    unlink(name.data());
+
+    // On tmpfs the pyramid would sit in RAM (or swap), however big the source
+    struct statfs fsInfo;
+    bool inMemory = fstatfs(m_fd, &fsInfo) == 0 &&
+                    (fsInfo.f_type == TMPFS_MAGIC || fsInfo.f_type == RAMFS_MAGIC);
+    if (inMemory && offset > kMaxMemoryScratchBytes) {
+        std::cerr << "Tile scratch directory " << scratchDirectory << " is in memory (tmpfs), refusing a "
+                  << (offset >> 20) << " MB tile pyramid" << std::endl;
+        close();
+        return false;
+    }
+
+    // Blocks are reserved up front; a sparse file running out of space would
+    // fault the builder's writes with SIGBUS instead of failing here
+    m_mapSize = static_cast<size_t>(offset);
+    int result = posix_fallocate(m_fd, 0, static_cast<off_t>(m_mapSize));
+    if (result != 0) {
+        std::cerr << "Failed to reserve " << (m_mapSize >> 20) << " MB for the tile pyramid in "
+                  << scratchDirectory << ": " << std::strerror(result) << std::endl;
+        close();
+        return false;
+    }
+
+    void* map = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        std::cerr << "Failed to map tile scratch file" << std::endl;
+        close();
+        return false;
+    }
+    m_map = static_cast<unsigned char*>(map);
+
+    m_rowsReady.reset(new std::atomic<int>[m_levels.size()]);
+    for (size_t i = 0; i < m_levels.size(); i++) {
+        m_rowsReady[i].store(0, std::memory_order_relaxed);
+    }
+
+    m_cancel = false;
+    m_complete = false;
+    m_builder = std::thread(&TiledImage::build, this);
+
+    return true;
+}
+
+void TiledImage::close()
+{
+    m_cancel = true;
+    if (m_builder.joinable()) {
+        m_builder.join();
+    }
+
+    releaseTiles();
+
+    if (m_map) {
+        munmap(m_map, m_mapSize);
+        m_map = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    m_mapSize = 0;
+    m_levels.clear();
+    m_rowsReady.reset();
+    m_complete = false;
+    m_width = 0;
+    m_height = 0;
+}
+
+void TiledImage::build()
+{
+    Profiler::setThreadName("tile builder");
+    PROFILE_SCOPE_DETAIL("buildTiles", m_path);
+
+    auto onRow = [this](const unsigned char* row, int y) {
+        storeRow(row, y);
+    };
+
+    bool ok = false;
+    if (m_source == Source::Jpeg) {
+        ok = JpegDecoder::decodeRows(m_path, onRow, &m_cancel);
+    } else if (m_source == Source::Png) {
+        ok = PngDecoder::decodeRows(m_path, m_channels, onRow, &m_cancel);
+    }
+
+    // CMYK JPEGs and everything stb-only go through a full decode
+    if (!ok && !m_cancel && m_rowsReady[0].load() == 0) {
+        ok = streamDecoded();
+    }
+
+    if (!ok) {
+        if (!m_cancel) {
+            std::cerr << "Failed to build tiles for: " << m_path << std::endl;
+        }
+        return;
+    }
+
+    m_complete = true;
+    if (m_wake) {
+        m_wake();
+    }
+}
+
+bool TiledImage::streamDecoded()
+{
+    DecodedImage image;
+    if (!ImageDecoder::decodeFile(m_path, image) || image.width != m_width || image.height != m_height) {
+        return false;
+    }
+
+    std::vector<unsigned char> row(static_cast<size_t>(m_width) * m_channels);
+    size_t stride = static_cast<size_t>(image.width) * image.channels;
+
+    for (int y = 0; y < m_height; y++)
+    {
+        if (m_cancel) {
+            return false;
+        }
+
+        // Decoded pixels are bottom row first
+        const unsigned char* source = image.pixels.data() + (m_height - 1 - y) * stride;
+        for (int x = 0; x < m_width; x++)
+        {
+            const unsigned char* pixel = source + x * image.channels;
+            unsigned char* target = row.data() + x * m_channels;
+
+            if (image.channels >= 3) {
+                target[0] = pixel[0];
+                target[1] = pixel[1];
+                target[2] = pixel[2];
+            } else {
+                target[0] = target[1] = target[2] = pixel[0];
+            }
+            if (m_channels == 4) {
+                target[3] = (image.channels == 4) ? pixel[3] : 255;
+            }
+        }
+
+        storeRow(row.data(), y);
+    }
+
+    return true;
+}
+
+void TiledImage::storeRow(const unsigned char* row, int y)
+{
+    if (y < 0 || y >= m_height) {
+        return;
+    }
+
+    int ty = y / kTileSize;
+    int rowInTile = y % kTileSize;
+    const Level& level = m_levels[0];
+
+    for (int tx = 0; tx < level.tilesX; tx++)
+    {
+        int validWidth, validHeight;
+        tileValidSize(0, tx, ty, validWidth, validHeight);
+
+        // Tile rows are stored bottom-up to match the texture orientation
+        unsigned char* target = tileData(0, tx, ty) +
+            static_cast<size_t>(validHeight - 1 - rowInTile) * kTileSize * m_channels;
+        std::memcpy(target, row + static_cast<size_t>(tx) * kTileSize * m_channels,
+                    static_cast<size_t>(validWidth) * m_channels);
+    }
+
+    if (rowInTile == std::min(kTileSize, m_height - ty * kTileSize) - 1) {
+        finishLevelZeroRows(ty + 1);
+    }
+}
+
+void TiledImage::finishLevelZeroRows(int rows)
+{
+    m_rowsReady[0].store(rows, std::memory_order_release);
+
+    // A coarser tile row needs the two finer tile rows under it
+    for (size_t level = 1; level < m_levels.size(); level++)
+    {
+        int finerReady = m_rowsReady[level - 1].load(std::memory_order_relaxed);
+        int finerRows = m_levels[level - 1].tilesY;
+        int ready = m_rowsReady[level].load(std::memory_order_relaxed);
+
+        while (ready < m_levels[level].tilesY && std::min(2 * ready + 1, finerRows - 1) < finerReady) {
+            buildLevelRow(static_cast<int>(level), ready);
+            ready++;
+            m_rowsReady[level].store(ready, std::memory_order_release);
+        }
+    }
+
+    if (m_wake) {
+        m_wake();
+    }
+}
+
+void TiledImage::buildLevelRow(int level, int tileRow)
+{
+    const Level& source = m_levels[level - 1];
+    const Level& target = m_levels[level];
+
+    // Pixel (x, y) of the finer level, y counted from the top
+    auto sourcePixel = [this, level, &source](int x, int y) {
+        int tx = x / kTileSize, ty = y / kTileSize;
+        int validWidth, validHeight;
+        tileValidSize(level - 1, tx, ty, validWidth, validHeight);
+        int storedRow = validHeight - 1 - y % kTileSize;
+        return tileData(level - 1, tx, ty) +
+               (static_cast<size_t>(storedRow) * kTileSize + x % kTileSize) * m_channels;
+    };
+
+    for (int tx = 0; tx < target.tilesX; tx++)
+    {
+        int validWidth, validHeight;
+        tileValidSize(level, tx, tileRow, validWidth, validHeight);
+        unsigned char* tile = tileData(level, tx, tileRow);
+
+        for (int row = 0; row < validHeight; row++)
+        {
+            int y = tileRow * kTileSize + row;
+            int y0 = 2 * y, y1 = std::min(2 * y + 1, source.height - 1);
+            unsigned char* out = tile + static_cast<size_t>(validHeight - 1 - row) * kTileSize * m_channels;
+
+            for (int column = 0; column < validWidth; column++)
+            {
+                int x = tx * kTileSize + column;
+                int x0 = 2 * x, x1 = std::min(2 * x + 1, source.width - 1);
+
+                const unsigned char* a = sourcePixel(x0, y0);
+                const unsigned char* b = sourcePixel(x1, y0);
+                const unsigned char* c = sourcePixel(x0, y1);
+                const unsigned char* d = sourcePixel(x1, y1);
+
+                for (int channel = 0; channel < m_channels; channel++) {
+                    out[channel] = static_cast<unsigned char>((a[channel] + b[channel] + c[channel] + d[channel] + 2) >> 2);
+                }
+                out += m_channels;
+            }
+        }
+    }
+}
+
+unsigned char* TiledImage::tileData(int level, int tx, int ty) const
+{
+    const Level& info = m_levels[level];
+    return m_map + info.offset + (static_cast<uint64_t>(ty) * info.tilesX + tx) * m_tileBytes;
+}
+
+void TiledImage::tileValidSize(int level, int tx, int ty, int& width, int& height) const
+{
+    const Level& info = m_levels[level];
+    width = std::min(kTileSize, info.width - tx * kTileSize);
+    height = std::min(kTileSize, info.height - ty * kTileSize);
+}
+
+bool TiledImage::hasPreview() const
+{
+    return !m_levels.empty() && isTileReady(static_cast<int>(m_levels.size()) - 1, 0);
+}
+
+bool TiledImage::isTileReady(int level, int ty) const
+{
+    return ty < m_rowsReady[level].load(std::memory_order_acquire);
+}
+
+uint64_t TiledImage::tileKey(int level, int tx, int ty)
+{
+    return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(ty) << 24) | static_cast<uint64_t>(tx);
+}
+
+bool TiledImage::render(Shader& shader, UniformMat4 modelUniform, GLuint vao, const glm::mat4& model, int viewportWidth, int viewportHeight)
+{
+    if (!m_map || m_levels.empty()) {
+        return true;
+    }
+
+    // On-screen size of one image pixel decides the level
+    float screenWidth = std::hypot(model[0][0] * viewportWidth * 0.5f, model[0][1] * viewportHeight * 0.5f);
+    int coarsest = static_cast<int>(m_levels.size()) - 1;
+    int level = 0;
+    if (screenWidth > 0.0f) {
+        float ratio = m_width / screenWidth;
+        level = (ratio > 1.0f) ? static_cast<int>(std::floor(std::log2(ratio))) : 0;
+        level = std::min(std::max(level, 0), coarsest);
+    }
+
+    // Visible part of the unit quad, from the screen corners in model space
+    glm::mat4 inverse = glm::inverse(model);
+    float minX = 0.5f, maxX = -0.5f, minY = 0.5f, maxY = -0.5f;
+    const float corners[4][2] = { {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f} };
+    for (const auto& corner : corners) {
+        glm::vec4 local = inverse * glm::vec4(corner[0], corner[1], 0.0f, 1.0f);
+        minX = std::min(minX, local.x);
+        maxX = std::max(maxX, local.x);
+        minY = std::min(minY, local.y);
+        maxY = std::max(maxY, local.y);
+    }
+    minX = std::max(minX, -0.5f);
+    maxX = std::min(maxX, 0.5f);
+    minY = std::max(minY, -0.5f);
+    maxY = std::min(maxY, 0.5f);
+    if (minX >= maxX || minY >= maxY) {
+        return true;
+    }
+
+    glBindVertexArray(vao);
+    glActiveTexture(GL_TEXTURE0);
+
+    int uploads = 0;
+    bool complete = true;
+
+    // The whole image at the coarsest level stands in for missing tiles
+    if (level != coarsest && isTileReady(coarsest, 0)) {
+        GLuint texture = findTile(tileKey(coarsest, 0, 0));
+        if (!texture) {
+            texture = uploadTile(coarsest, 0, 0);
+            uploads++;
+        }
+        drawTile(shader, modelUniform, model, coarsest, 0, 0, texture);
+    }
+
+    const Level& info = m_levels[level];
+    int firstX = std::max(0, static_cast<int>((minX + 0.5f) * info.width) / kTileSize);
+    int lastX = std::min(info.tilesX - 1, static_cast<int>((maxX + 0.5f) * info.width) / kTileSize);
+    int firstY = std::max(0, static_cast<int>((0.5f - maxY) * info.height) / kTileSize);
+    int lastY = std::min(info.tilesY - 1, static_cast<int>((0.5f - minY) * info.height) / kTileSize);
+
+    for (int ty = firstY; ty <= lastY; ty++)
+    {
+        if (!isTileReady(level, ty)) {
+            break;
+        }
+
+        for (int tx = firstX; tx <= lastX; tx++)
+        {
+            GLuint texture = findTile(tileKey(level, tx, ty));
+            if (!texture) {
+                if (uploads >= m_maxUploadsPerFrame) {
+                    complete = false;
+                    continue;
+                }
+                texture = uploadTile(level, tx, ty);
+                uploads++;
+            }
+            drawTile(shader, modelUniform, model, level, tx, ty, texture);
+        }
+    }
+
+    glBindVertexArray(0);
+    return complete;
+}
+
+GLuint TiledImage::findTile(uint64_t key)
+{
+    auto it = m_gpuLookup.find(key);
+    if (it == m_gpuLookup.end()) {
+        return 0;
+    }
+
+    m_gpuTiles.splice(m_gpuTiles.begin(), m_gpuTiles, it->second);
+    return it->second->texture;
+}
+
+GLuint TiledImage::uploadTile(int level, int tx, int ty)
+{
+    int validWidth, validHeight;
+    tileValidSize(level, tx, ty, validWidth, validHeight);
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    GLenum format = (m_channels == 4) ? GL_RGBA : GL_RGB;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, kTileSize);
+    glTexImage2D(GL_TEXTURE_2D, 0, (m_channels == 4) ? GL_RGBA8 : GL_RGB8, validWidth, validHeight, 0,
+                 format, GL_UNSIGNED_BYTE, tileData(level, tx, ty));
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    m_gpuTiles.push_front({tileKey(level, tx, ty), texture});
+    m_gpuLookup[m_gpuTiles.front().key] = m_gpuTiles.begin();
+
+    // Least recently drawn tiles go first; the new one is at the front
+    while (static_cast<int>(m_gpuTiles.size()) > std::max(1, m_maxResidentTiles)) {
+        GpuTile& victim = m_gpuTiles.back();
+        glDeleteTextures(1, &victim.texture);
+        m_gpuLookup.erase(victim.key);
+        m_gpuTiles.pop_back();
+    }
+
+    return texture;
+}
+
+void TiledImage::drawTile(Shader& shader, UniformMat4 modelUniform, const glm::mat4& model, int level, int tx, int ty, GLuint texture)
+{
+    const Level& info = m_levels[level];
+    int validWidth, validHeight;
+    tileValidSize(level, tx, ty, validWidth, validHeight);
+
+    // Tile rectangle inside the unit quad, y up
+    float width = static_cast<float>(validWidth) / info.width;
+    float height = static_cast<float>(validHeight) / info.height;
+    float left = static_cast<float>(tx * kTileSize) / info.width - 0.5f;
+    float top = 0.5f - static_cast<float>(ty * kTileSize) / info.height;
+
+    glm::mat4 tileModel = glm::translate(model, glm::vec3(left + width * 0.5f, top - height * 0.5f, 0.0f));
+    tileModel = glm::scale(tileModel, glm::vec3(width, height, 1.0f));
+
+    shader.set(modelUniform, tileModel);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
+
+void TiledImage::releaseTiles()
+{
+    for (GpuTile& tile : m_gpuTiles) {
+        glDeleteTextures(1, &tile.texture);
+    }
+    m_gpuTiles.clear();
+    m_gpuLookup.clear();
+}
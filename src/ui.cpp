@@ -8,13 +8,12 @@
 
 #include "ui.h"
 #include <iostream>
+#include <algorithm>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 
 UIElement::UIElement(float x, float y, float width, float height)
-    : m_x(x), m_y(y), m_width(width), m_height(height), m_visible(true)
+    : m_x(x), m_y(y), m_width(width), m_height(height), m_visible(true), m_hovered(false), m_dirty(true)
 {}
 
 bool UIElement::isMouseOver(float mouseX, float mouseY) const
@@ -27,19 +26,28 @@ bool UIElement::isMouseOver(float mouseX, float mouseY) const
 
 void UIElement::setPosition(float x, float y)
 {
-    m_x = x;
-    m_y = y;
+    if (x != m_x || y != m_y) {
+        m_x = x;
+        m_y = y;
+        m_dirty = true;
+    }
 }
 
 void UIElement::setSize(float width, float height)
 {
-    m_width = width;
-    m_height = height;
+    if (width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_dirty = true;
+    }
 }
 
 void UIElement::setVisible(bool visible)
 {
-    m_visible = visible;
+    if (visible != m_visible) {
+        m_visible = visible;
+        m_dirty = true;
+    }
 }
 
 bool UIElement::isVisible() const
@@ -47,33 +55,40 @@ bool UIElement::isVisible() const
     return m_visible;
 }
 
+void UIElement::setHovered(bool hovered)
+{
+    if (hovered != m_hovered) {
+        m_hovered = hovered;
+        m_dirty = true;
+    }
+}
+
+bool UIElement::clearDirty()
+{
+    bool dirty = m_dirty;
+    m_dirty = false;
+    return dirty;
+}
+
 Button::Button(float x, float y, float width, float height, const std::string& text)
-    : UIElement(x, y, width, height), m_text(text), m_callback(nullptr)
+    : UIElement(x, y, width, height), m_text(text), m_callback(nullptr), m_layoutDirty(true)
 {
 }
 
-void Button::render()
+void Button::render(UIRenderer& renderer)
 {
     if (!m_visible) return;
     
-    glBegin(GL_QUADS);
-    glColor3f(0.3f, 0.3f, 0.3f);
-    glVertex2f(m_x, m_y);
-    glVertex2f(m_x + m_width, m_y);
-    glVertex2f(m_x + m_width, m_y + m_height);
-    glVertex2f(m_x, m_y + m_height);
-    glEnd();
-    
-    glBegin(GL_LINE_LOOP);
-    glColor3f(0.7f, 0.7f, 0.7f);
-    glVertex2f(m_x, m_y);
-    glVertex2f(m_x + m_width, m_y);
-    glVertex2f(m_x + m_width, m_y + m_height);
-    glVertex2f(m_x, m_y + m_height);
-    glEnd();
+    float fill = m_hovered ? 0.4f : 0.3f;
+    renderer.addRect(m_x, m_y, m_width, m_height, glm::vec4(fill, fill, fill, 1.0f));
+    renderer.addOutline(m_x, m_y, m_width, m_height, 1.0f, glm::vec4(0.7f, 0.7f, 0.7f, 1.0f));
     
-    glColor3f(1.0f, 1.0f, 1.0f);
-    // TODO
+    if (m_layoutDirty) {
+        renderer.layoutText(m_text, m_textMesh);
+        m_layoutDirty = false;
+    }
+    renderer.addText(m_textMesh, m_x + (m_width - m_textMesh.width) * 0.5f,
+                     m_y + (m_height - m_textMesh.height) * 0.5f, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
 }
 
 void Button::onMouseClick()
@@ -85,7 +100,11 @@ void Button::onMouseClick()
 
 void Button::setText(const std::string& text)
 {
-    m_text = text;
+    if (text != m_text) {
+        m_text = text;
+        m_layoutDirty = true;
+        m_dirty = true;
+    }
 }
 
 void Button::setCallback(std::function<void()> callback)
@@ -94,46 +113,56 @@ void Button::setCallback(std::function<void()> callback)
 }
 
 Label::Label(float x, float y, const std::string& text)
-    : UIElement(x, y, 0, 0), m_text(text)
+    : UIElement(x, y, 0, 0), m_text(text), m_layoutDirty(true)
 {
     m_width = text.length() * 8.0f;  
     m_height = 20.0f;
 }
 
-void Label::render()
+void Label::render(UIRenderer& renderer)
 {
     if (!m_visible) return;
     
-    glColor3f(1.0f, 1.0f, 1.0f);
-    // TODO
+    // The size follows the text, for hit testing as well
+    if (m_layoutDirty) {
+        renderer.layoutText(m_text, m_textMesh);
+        m_width = m_textMesh.width;
+        m_height = std::max(m_textMesh.height, renderer.getLineHeight());
+        m_layoutDirty = false;
+    }
+    if (m_textMesh.vertices.empty()) {
+        return;
+    }
+    
+    // Backdrop so the text stays readable over bright images
+    const float padding = 3.0f;
+    renderer.addRect(m_x - padding, m_y - padding, m_width + 2.0f * padding, m_height + 2.0f * padding,
+                     glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+    renderer.addText(m_textMesh, m_x, m_y, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
 }
 
 void Label::setText(const std::string& text)
 {
-    m_text = text;
-    m_width = text.length() * 8.0f;
+    setText(text.c_str());
+}
+
+void Label::setText(const char* text)
+{
+    // Called every drawn frame, mostly with the same text
+    if (m_text == text) {
+        return;
+    }
+    m_text.assign(text);
+    m_layoutDirty = true;
+    m_dirty = true;
 }
 
 UIManager::UIManager()
-    : m_windowWidth(0), m_windowHeight(0), m_hoveredElement(nullptr),
-      m_vao(0), m_vbo(0), m_textVAO(0), m_textVBO(0)
+    : m_windowWidth(0), m_windowHeight(0), m_hoveredElement(nullptr), m_dirty(true)
 {}
 
 UIManager::~UIManager()
 {
-    if (m_vao != 0) {
-        glDeleteVertexArrays(1, &m_vao);
-    }
-    if (m_vbo != 0) {
-        glDeleteBuffers(1, &m_vbo);
-    }
-    if (m_textVAO != 0) {
-        glDeleteVertexArrays(1, &m_textVAO);
-    }
-    if (m_textVBO != 0) {
-        glDeleteBuffers(1, &m_textVBO);
-    }
-    
     for (auto element : m_elements) {
         delete element;
     }
@@ -141,55 +170,41 @@ UIManager::~UIManager()
     m_elements.clear();
 }
 
-void UIManager::initialize(int windowWidth, int windowHeight)
+bool UIManager::initialize(int windowWidth, int windowHeight, ShaderManager& shaderManager)
 {
     m_windowWidth = windowWidth;
     m_windowHeight = windowHeight;
+    m_dirty = true;
     
-    // TODO
-    
-    glGenVertexArrays(1, &m_vao);
-    glGenBuffers(1, &m_vbo);
-    
-    glGenVertexArrays(1, &m_textVAO);
-    glGenBuffers(1, &m_textVBO);
+    return m_renderer.initialize(shaderManager);
 }
 
 void UIManager::render()
 {
-    glPushAttrib(GL_ALL_ATTRIB_BITS);
-    
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0, m_windowWidth, m_windowHeight, 0, -1, 1);
-    
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-    
-    glDisable(GL_DEPTH_TEST);
-    
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
+    // Every element's flag is cleared, not just up to the first dirty one
+    bool dirty = m_dirty;
     for (auto element : m_elements) {
-        if (element->isVisible()) {
-            element->render();
-        }
+        dirty = element->clearDirty() || dirty;
     }
     
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    if (dirty) 
+    {
+        m_renderer.clear();
+        for (auto element : m_elements) {
+            if (element->isVisible()) {
+                element->render(m_renderer);
+            }
+        }
+        m_renderer.upload();
+        m_dirty = false;
+    }
     
-    glPopAttrib();
+    m_renderer.draw(m_windowWidth, m_windowHeight);
 }
 
-void UIManager::handleMouseMove(float mouseX, float mouseY)
+bool UIManager::handleMouseMove(float mouseX, float mouseY)
 {
+    UIElement* previous = m_hoveredElement;
     m_hoveredElement = nullptr;
     for (auto it = m_elements.rbegin(); it != m_elements.rend(); ++it) {
         if ((*it)->isMouseOver(mouseX, mouseY)) {
@@ -197,6 +212,17 @@ void UIManager::handleMouseMove(float mouseX, float mouseY)
             break;
         }
     }
+    
+    if (m_hoveredElement == previous) {
+        return false;
+    }
+    if (previous) {
+        previous->setHovered(false);
+    }
+    if (m_hoveredElement) {
+        m_hoveredElement->setHovered(true);
+    }
+    return true;
 }
 
 bool UIManager::handleMouseClick(float mouseX, float mouseY)
@@ -214,6 +240,7 @@ bool UIManager::handleMouseClick(float mouseX, float mouseY)
 void UIManager::addElement(UIElement* element)
 {
     m_elements.push_back(element);
+    m_dirty = true;
 }
 
 void UIManager::removeElement(UIElement* element)
@@ -221,6 +248,10 @@ void UIManager::removeElement(UIElement* element)
     auto it = std::find(m_elements.begin(), m_elements.end(), element);
     if (it != m_elements.end()) {
         m_elements.erase(it);
+        m_dirty = true;
+    }
+    if (m_hoveredElement == element) {
+        m_hoveredElement = nullptr;
     }
 }
 
@@ -0,0 +1,256 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    ui_renderer.cpp                                               //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "ui_renderer.h"
+#include "shader_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+namespace {
+
+const float kFontPixelHeight = 16.0f;
+
+// Malformed sequences come out as '?', one byte at a time
+uint32_t decodeUtf8(const std::string& text, size_t& index)
+{
+    unsigned char lead = static_cast<unsigned char>(text[index++]);
+    if (lead < 0x80) {
+        return lead;
+    }
+
+    int extra = (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : (lead >= 0xC0) ? 1 : -1;
+    if (extra < 0 || index + extra > text.size()) {
+        return '?';
+    }
+    uint32_t codepoint = lead & (0x3F >> extra);
+    for (int i = 0; i < extra; i++) {
+        unsigned char next = static_cast<unsigned char>(text[index + i]);
+        if ((next & 0xC0) != 0x80) {
+            return '?';
+        }
+        codepoint = (codepoint << 6) | (next & 0x3F);
+    }
+    index += extra;
+    return codepoint;
+}
+
+} // namespace
+
+UIRenderer::UIRenderer()
+    : m_shader(nullptr), m_atlasTexture(0), m_whiteU(0.5f), m_whiteV(0.5f),
+      m_vao(0), m_vbo(0), m_capacity(0), m_uploadedCount(0)
+{
+}
+
+UIRenderer::~UIRenderer()
+{
+    if (m_vao != 0) {
+        glDeleteVertexArrays(1, &m_vao);
+    }
+    if (m_vbo != 0) {
+        glDeleteBuffers(1, &m_vbo);
+    }
+    if (m_atlasTexture != 0) {
+        glDeleteTextures(1, &m_atlasTexture);
+    }
+}
+
+bool UIRenderer::initialize(ShaderManager& shaderManager)
+{
+    m_shader = shaderManager.get("ui");
+    if (!m_shader) {
+        std::cerr << "Failed to load UI shaders" << std::endl;
+        return false;
+    }
+    m_screenSizeUniform = m_shader->getUniform<glm::vec2>("screenSize");
+    m_shader->use();
+    m_shader->set(m_shader->getUniform<int>("atlasTexture"), 0);
+    
+    // Without a font the widgets still draw, just without their text
+    std::string fontPath = Font::findDefaultPath();
+    if (fontPath.empty()) {
+        std::cerr << "No font found, set PICASA_FONT to a .ttf file to show text" << std::endl;
+    } else {
+        m_font.load(fontPath, kFontPixelHeight);
+    }
+    createAtlasTexture();
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, x)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, u)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void UIRenderer::clear()
+{
+    m_vertices.clear();
+}
+
+void UIRenderer::addRect(float x, float y, float width, float height, const glm::vec4& color)
+{
+    if (width <= 0.0f || height <= 0.0f) {
+        return;
+    }
+
+    uint32_t packed = packColor(color);
+    float right = x + width;
+    float bottom = y + height;
+    m_vertices.push_back({x, y, m_whiteU, m_whiteV, packed});
+    m_vertices.push_back({right, y, m_whiteU, m_whiteV, packed});
+    m_vertices.push_back({right, bottom, m_whiteU, m_whiteV, packed});
+    m_vertices.push_back({right, bottom, m_whiteU, m_whiteV, packed});
+    m_vertices.push_back({x, bottom, m_whiteU, m_whiteV, packed});
+    m_vertices.push_back({x, y, m_whiteU, m_whiteV, packed});
+}
+
+void UIRenderer::addOutline(float x, float y, float width, float height, float thickness, const glm::vec4& color)
+{
+    // Top and bottom span the full width, the sides fill in between
+    thickness = std::min(thickness, std::min(width, height) * 0.5f);
+    addRect(x, y, width, thickness, color);
+    addRect(x, y + height - thickness, width, thickness, color);
+    addRect(x, y + thickness, thickness, height - 2.0f * thickness, color);
+    addRect(x + width - thickness, y + thickness, thickness, height - 2.0f * thickness, color);
+}
+
+void UIRenderer::layoutText(const std::string& text, TextMesh& mesh) const
+{
+    mesh.vertices.clear();
+    mesh.width = 0.0f;
+    mesh.height = 0.0f;
+    if (!m_font.isLoaded() || text.empty()) {
+        return;
+    }
+
+    const uint32_t white = 0xFFFFFFFFu;
+    float lineHeight = m_font.getLineHeight();
+    float penX = 0.0f;
+    float baseline = m_font.getAscent();
+    size_t index = 0;
+    while (index < text.size()) 
+    {
+        uint32_t codepoint = decodeUtf8(text, index);
+        if (codepoint == '\n') {
+            mesh.width = std::max(mesh.width, penX);
+            penX = 0.0f;
+            baseline += lineHeight;
+            continue;
+        }
+
+        const Font::Glyph& glyph = m_font.getGlyph(codepoint);
+        if (glyph.width > 0.0f && glyph.height > 0.0f) 
+        {
+            // Whole pixels keep the atlas texels one to one with the screen
+            float left = std::round(penX + glyph.xOffset);
+            float top = baseline + glyph.yOffset;
+            float right = left + glyph.width;
+            float bottom = top + glyph.height;
+            mesh.vertices.push_back({left, top, glyph.u0, glyph.v0, white});
+            mesh.vertices.push_back({right, top, glyph.u1, glyph.v0, white});
+            mesh.vertices.push_back({right, bottom, glyph.u1, glyph.v1, white});
+            mesh.vertices.push_back({right, bottom, glyph.u1, glyph.v1, white});
+            mesh.vertices.push_back({left, bottom, glyph.u0, glyph.v1, white});
+            mesh.vertices.push_back({left, top, glyph.u0, glyph.v0, white});
+        }
+        penX += glyph.advance;
+    }
+
+    mesh.width = std::ceil(std::max(mesh.width, penX));
+    mesh.height = baseline - m_font.getAscent() + lineHeight;
+}
+
+void UIRenderer::addText(const TextMesh& mesh, float x, float y, const glm::vec4& color)
+{
+    uint32_t packed = packColor(color);
+    x = std::round(x);
+    y = std::round(y);
+    for (const Vertex& vertex : mesh.vertices) {
+        m_vertices.push_back({vertex.x + x, vertex.y + y, vertex.u, vertex.v, packed});
+    }
+}
+
+float UIRenderer::getLineHeight() const
+{
+    return m_font.isLoaded() ? m_font.getLineHeight() : kFontPixelHeight;
+}
+
+void UIRenderer::upload()
+{
+    m_uploadedCount = static_cast<GLsizei>(m_vertices.size());
+    if (m_vbo == 0 || m_vertices.empty()) {
+        return;
+    }
+
+    size_t bytes = m_vertices.size() * sizeof(Vertex);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    if (bytes > m_capacity) {
+        m_capacity = bytes * 2;
+        glBufferData(GL_ARRAY_BUFFER, m_capacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, m_vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void UIRenderer::draw(int windowWidth, int windowHeight)
+{
+    if (!m_shader || m_uploadedCount == 0) {
+        return;
+    }
+
+    m_shader->use();
+    m_shader->set(m_screenSizeUniform, glm::vec2(static_cast<float>(windowWidth), static_cast<float>(windowHeight)));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+    glBindVertexArray(m_vao);
+    glDrawArrays(GL_TRIANGLES, 0, m_uploadedCount);
+    glBindVertexArray(0);
+}
+
+void UIRenderer::createAtlasTexture()
+{
+    // A single white texel stands in for the atlas when no font loaded
+    const unsigned char white = 255;
+    const unsigned char* pixels = m_font.isLoaded() ? m_font.getAtlas() : &white;
+    int width = m_font.isLoaded() ? m_font.getAtlasWidth() : 1;
+    int height = m_font.isLoaded() ? m_font.getAtlasHeight() : 1;
+    m_whiteU = m_font.isLoaded() ? m_font.getWhiteU() : 0.5f;
+    m_whiteV = m_font.isLoaded() ? m_font.getWhiteV() : 0.5f;
+
+    glGenTextures(1, &m_atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+uint32_t UIRenderer::packColor(const glm::vec4& color)
+{
+    auto channel = [](float value) {
+        return static_cast<uint32_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    };
+    // Byte order in memory is R, G, B, A on little endian hosts
+    return channel(color.x) | (channel(color.y) << 8) | (channel(color.z) << 16) | (channel(color.w) << 24);
+}
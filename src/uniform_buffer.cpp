@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    uniform_buffer.cpp                                            //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 17/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "uniform_buffer.h"
+
+#include <iostream>
+
+UniformBuffer::UniformBuffer()
+    : m_id(0), m_binding(0), m_size(0)
+{
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    if (m_id != 0) {
+        glDeleteBuffers(1, &m_id);
+    }
+}
+
+bool UniformBuffer::create(GLuint binding, size_t size)
+{
+    if (m_id == 0) {
+        glGenBuffers(1, &m_id);
+    }
+    if (m_id == 0) {
+        std::cerr << "Failed to create uniform buffer" << std::endl;
+        return false;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_id);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_id);
+
+    m_binding = binding;
+    m_size = size;
+    return true;
+}
+
+void UniformBuffer::update(const void* data, size_t size)
+{
+    if (m_id == 0 || size > m_size) {
+        return;
+    }
+
+    // Orphan the old storage so a frame still reading it never stalls us
+    glBindBuffer(GL_UNIFORM_BUFFER, m_id);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(m_size), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,399 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// FILE :    upload_stream.cpp                                             //
+// AUTHOR :  0xcds4r                                                      //
+// CREATED : 16/10/2026                                                  //
+//                                                                      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "upload_stream.h"
+#include "texture.h"
+#include "image_decoder.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Keeps every copy's source offset aligned for any pixel format
+const size_t kAllocationAlignment = 64;
+
+size_t alignUp(size_t value)
+{
+    return (value + kAllocationAlignment - 1) & ~(kAllocationAlignment - 1);
+}
+
+} // namespace
+
+UploadStream::UploadStream()
+    : m_buffer(0),
+      m_persistent(false),
+      m_persistentMap(nullptr),
+      m_sectionSize(0),
+      m_sectionCount(0),
+      m_section(0),
+      m_sectionMap(nullptr),
+      m_used(0),
+      m_available(false),
+      m_bandSection(0),
+      m_copyBusy(false),
+      m_copyStopping(false)
+{
+}
+
+UploadStream::~UploadStream()
+{
+    shutdown();
+}
+
+bool UploadStream::initialize(size_t bytesPerFrame, int framesInFlight)
+{
+    shutdown();
+
+    m_sectionSize = alignUp(std::max<size_t>(bytesPerFrame, kAllocationAlignment));
+    m_sectionCount = std::max(2, framesInFlight);
+    m_fences.assign(m_sectionCount, nullptr);
+    size_t bufferSize = m_sectionSize * m_sectionCount;
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+
+    if (GLEW_ARB_buffer_storage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, flags);
+        m_persistentMap = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize, flags));
+        m_persistent = m_persistentMap != nullptr;
+
+        // Immutable storage cannot be respecified, start over with a plain buffer
+        if (!m_persistent) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+        }
+    }
+
+    if (!m_persistent) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "Failed to create texture upload buffer" << std::endl;
+        shutdown();
+        return false;
+    }
+
+    // A persistent map stays valid off the GL thread, so image bands can be
+    // written into it there
+    if (m_persistent) {
+        m_copyStopping = false;
+        m_copyThread = std::thread(&UploadStream::copyLoop, this);
+    }
+
+    return true;
+}
+
+void UploadStream::shutdown()
+{
+    if (m_copyThread.joinable()) {
+        waitForBandWrites();
+        {
+            std::lock_guard<std::mutex> lock(m_copyMutex);
+            m_copyStopping = true;
+        }
+        m_copyCondition.notify_all();
+        m_copyThread.join();
+    }
+    m_bandWrites.clear();
+    m_bandCopies.clear();
+
+    for (GLsync& fence : m_fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (m_buffer != 0) {
+        if (m_persistentMap || m_sectionMap) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+
+    m_persistent = false;
+    m_persistentMap = nullptr;
+    m_sectionMap = nullptr;
+    m_available = false;
+    m_copies.clear();
+    m_jobs.clear();
+}
+
+void UploadStream::beginFrame()
+{
+    finishBands();
+
+    m_available = false;
+    m_used = 0;
+    m_stats.frameBytes = 0;
+
+    if (m_buffer == 0) {
+        return;
+    }
+
+    m_section = (m_section + 1) % m_sectionCount;
+
+    // Polled, never waited on: a busy section just means no uploads this frame
+    GLsync& fence = m_fences[m_section];
+    if (fence) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            m_stats.stalledFrames++;
+            return;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    size_t sectionOffset = static_cast<size_t>(m_section) * m_sectionSize;
+    if (m_persistent) {
+        m_sectionMap = m_persistentMap + sectionOffset;
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+        m_sectionMap = static_cast<unsigned char*>(glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER, sectionOffset, m_sectionSize,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    m_available = m_sectionMap != nullptr;
+}
+
+void UploadStream::endFrame()
+{
+    if (!m_available) {
+        return;
+    }
+
+    // Whatever budget the direct writers left goes to the texture jobs
+    streamTextureJobs();
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+    if (!m_persistent) {
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    m_sectionMap = nullptr;
+    m_available = false;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const Copy& copy : m_copies) {
+        issueCopy(copy);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // With bands still being written the fence waits for their copies
+    if (!m_bandWrites.empty()) {
+        m_bandSection = m_section;
+        {
+            std::lock_guard<std::mutex> lock(m_copyMutex);
+            m_copyBusy = true;
+        }
+        m_copyCondition.notify_all();
+    } else if (!m_copies.empty()) {
+        m_fences[m_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    m_copies.clear();
+
+    m_stats.frameBytes = m_used;
+    m_stats.totalBytes += m_used;
+    m_stats.pendingTextures = countPendingTextures();
+}
+
+void UploadStream::issueCopy(const Copy& copy)
+{
+    glBindTexture(copy.target, copy.texture);
+    if (copy.compressedBytes > 0) {
+        glCompressedTexSubImage3D(copy.target, 0, 0, copy.y, copy.layer, copy.width, copy.height, 1,
+                                  copy.format, static_cast<GLsizei>(copy.compressedBytes),
+                                  reinterpret_cast<const void*>(copy.offset));
+    } else if (copy.target == GL_TEXTURE_2D_ARRAY) {
+        glTexSubImage3D(copy.target, 0, 0, copy.y, copy.layer, copy.width, copy.height, 1,
+                        copy.format, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(copy.offset));
+    } else {
+        glTexSubImage2D(copy.target, 0, 0, copy.y, copy.width, copy.height,
+                        copy.format, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(copy.offset));
+    }
+    if (copy.generateMipmap) {
+        glGenerateMipmap(copy.target);
+    }
+}
+
+void UploadStream::finishBands()
+{
+    if (m_bandWrites.empty()) {
+        return;
+    }
+
+    // Normally done already, the writes had the whole render to run
+    waitForBandWrites();
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const BandCopy& band : m_bandCopies) {
+        issueCopy(band.copy);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // Also covers the section's direct copies issued at endFrame()
+    m_fences[m_bandSection] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_bandWrites.clear();
+    m_bandCopies.clear();
+    m_stats.pendingTextures = countPendingTextures();
+}
+
+void UploadStream::waitForBandWrites()
+{
+    std::unique_lock<std::mutex> lock(m_copyMutex);
+    m_copyCondition.wait(lock, [this] { return !m_copyBusy; });
+}
+
+void UploadStream::copyLoop()
+{
+    std::unique_lock<std::mutex> lock(m_copyMutex);
+    while (true)
+    {
+        m_copyCondition.wait(lock, [this] { return m_copyBusy || m_copyStopping; });
+        if (m_copyStopping) {
+            return;
+        }
+
+        lock.unlock();
+        for (const BandWrite& write : m_bandWrites) {
+            std::memcpy(write.target, write.source, write.bytes);
+        }
+        lock.lock();
+
+        m_copyBusy = false;
+        m_copyCondition.notify_all();
+    }
+}
+
+size_t UploadStream::countPendingTextures() const
+{
+    // A job leaves the queue once its last band is written, not yet issued
+    size_t count = m_jobs.size();
+    for (const BandCopy& band : m_bandCopies) {
+        if (band.copy.generateMipmap) {
+            count++;
+        }
+    }
+    return count;
+}
+
+unsigned char* UploadStream::allocate(size_t bytes, size_t& offset)
+{
+    if (!m_available || bytes == 0 || m_used + bytes > m_sectionSize) {
+        return nullptr;
+    }
+
+    unsigned char* target = m_sectionMap + m_used;
+    offset = static_cast<size_t>(m_section) * m_sectionSize + m_used;
+    m_used = std::min(alignUp(m_used + bytes), m_sectionSize);
+    return target;
+}
+
+void UploadStream::copyToTexture(GLuint texture, int width, int height, GLenum format, size_t offset)
+{
+    m_copies.push_back({GL_TEXTURE_2D, texture, 0, 0, width, height, format, offset, false});
+}
+
+void UploadStream::copyToTextureLayer(GLuint texture, int layer, int width, int height, GLenum format, size_t offset)
+{
+    m_copies.push_back({GL_TEXTURE_2D_ARRAY, texture, 0, layer, width, height, format, offset, false});
+}
+
+void UploadStream::copyCompressedToTextureLayer(GLuint texture, int layer, int width, int height, GLenum format,
+                                                size_t bytes, size_t offset)
+{
+    m_copies.push_back({GL_TEXTURE_2D_ARRAY, texture, 0, layer, width, height, format, offset, false, bytes});
+}
+
+void UploadStream::uploadTexture(const std::shared_ptr<Texture>& texture, std::shared_ptr<const DecodedImage> image)
+{
+    TextureJob job;
+    job.texture = texture;
+    job.image = std::move(image);
+    m_jobs.push_back(std::move(job));
+    m_stats.pendingTextures = countPendingTextures();
+}
+
+bool UploadStream::isPending(const Texture* texture) const
+{
+    for (const TextureJob& job : m_jobs) {
+        if (job.texture.get() == texture) {
+            return true;
+        }
+    }
+    for (const BandCopy& band : m_bandCopies) {
+        if (band.texture.get() == texture) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UploadStream::cancel(const Texture* texture)
+{
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(),
+                                [texture](const TextureJob& job) { return job.texture.get() == texture; }),
+                 m_jobs.end());
+    // The write may be running, only its copy is dropped
+    m_bandCopies.erase(std::remove_if(m_bandCopies.begin(), m_bandCopies.end(),
+                                      [texture](const BandCopy& band) { return band.texture.get() == texture; }),
+                       m_bandCopies.end());
+    m_stats.pendingTextures = countPendingTextures();
+}
+
+void UploadStream::streamTextureJobs()
+{
+    while (!m_jobs.empty())
+    {
+        TextureJob& job = m_jobs.front();
+        const DecodedImage& image = *job.image;
+        size_t rowBytes = static_cast<size_t>(image.width) * image.channels;
+
+        // Bottom row first in both the image and GL, so bands copy straight across
+        int rows = static_cast<int>(std::min<size_t>(image.height - job.nextRow, (m_sectionSize - m_used) / rowBytes));
+        size_t offset;
+        unsigned char* target = (rows > 0) ? allocate(rows * rowBytes, offset) : nullptr;
+        if (!target) {
+            return;
+        }
+
+        const unsigned char* source = image.pixels.data() + job.nextRow * rowBytes;
+        bool last = job.nextRow + rows == image.height;
+        Copy copy = {GL_TEXTURE_2D, job.texture->getId(), job.nextRow, 0, image.width, rows,
+                     job.texture->getFormat(), offset, last};
+
+        if (m_copyThread.joinable()) {
+            m_bandWrites.push_back({job.image, source, target, rows * rowBytes});
+            m_bandCopies.push_back({job.texture, copy});
+        } else {
+            std::memcpy(target, source, rows * rowBytes);
+            m_copies.push_back(copy);
+        }
+        job.nextRow += rows;
+
+        if (last) {
+            m_jobs.pop_front();
+        }
+    }
+}